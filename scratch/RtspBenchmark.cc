@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// RTSP 시뮬레이션 비용 측정
+//
+// RtspScenarioHelper 시나리오를 클라이언트 수를 늘려가며 실행하고
+// 실행마다 아래 값을 CSV 한 줄로 출력합니다.
+//
+//   clients,simSeconds,streamSeconds,wallSeconds,events,peakRssKb,
+//   eventsPerSimSecond,wallUsPerStreamSecond,goodputMbps
+//
+// - 실행마다 fork한 자식 프로세스에서 돌려서 peak RSS(getrusage)가 실행 별로 측정됨
+// - streamSeconds: 클라이언트 수 * PLAY 이후 재생 시간
+// - --packetPoolSize로 서버 RTP 패킷 풀을 켜고 끈 두 실행을 비교할 수 있음
+//
+// ./waf --run "RtspBenchmark --counts=1,10,100,1000 --output=bench.csv"
+// ./waf --run "RtspBenchmark --counts=1,10,100,1000 --packetPoolSize=16 --output=bench-pool.csv"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/rtsp-scenario-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RtspBenchmark");
+
+struct BenchmarkConfig
+{
+  std::string topology;
+  uint32_t servers;
+  uint32_t branches;
+  std::string bottleneckRate;
+  std::string accessRate;
+  double stagger;
+  double stopTime;
+  std::string fileName;
+  uint32_t packetPoolSize;
+};
+
+//시나리오 한 번 실행, 결과를 CSV 한 줄로 반환
+static std::string
+RunOnce (const BenchmarkConfig &config, uint32_t clients)
+{
+  RtspScenarioHelper scenario;
+  scenario.SetTopology (config.topology == "tree" ? RtspScenarioHelper::TREE : RtspScenarioHelper::DUMBBELL);
+  scenario.SetClientCount (clients);
+  scenario.SetServerCount (config.servers);
+  scenario.SetTreeBranches (config.branches);
+  scenario.SetBottleneck (config.bottleneckRate, "20ms");
+  scenario.SetAccessLink (config.accessRate, "1ms");
+  scenario.SetSchedule (Seconds (1), Seconds (config.stagger), Seconds (1));
+  scenario.SetStopTime (Seconds (config.stopTime));
+  scenario.SetClientAttribute ("FileName", StringValue (config.fileName));
+  scenario.SetServerAttribute ("PacketPoolSize", UintegerValue (config.packetPoolSize));
+  scenario.Build ();
+
+  auto start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  uint64_t events = Simulator::GetEventCount ();
+  double simSeconds = Simulator::Now ().GetSeconds ();
+  uint64_t goodput = 0;
+  double streamSeconds = 0;
+  for (uint32_t i = 0; i < clients; i++)
+    {
+      goodput += scenario.GetClient (i)->GetGoodputSize ();
+      double play = 2 + config.stagger * i;
+      if (config.stopTime > play)
+        {
+          streamSeconds += config.stopTime - play;
+        }
+    }
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  std::ostringstream line;
+  line << clients << ',' << simSeconds << ',' << streamSeconds << ',' << wall << ','
+       << events << ',' << usage.ru_maxrss << ','
+       << (simSeconds > 0 ? events / simSeconds : 0) << ','
+       << (streamSeconds > 0 ? wall * 1e6 / streamSeconds : 0) << ','
+       << goodput * 8.0 / config.stopTime / 1e6;
+  return line.str ();
+}
+
+//자식 프로세스에서 실행하고 파이프로 결과를 받음
+static std::string
+RunInChild (const BenchmarkConfig &config, uint32_t clients)
+{
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      NS_FATAL_ERROR ("pipe failed");
+    }
+
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("fork failed");
+    }
+  if (pid == 0)
+    {
+      close (fds[0]);
+      std::string line = RunOnce (config, clients);
+      ssize_t written = write (fds[1], line.data (), line.size ());
+      NS_UNUSED (written);
+      close (fds[1]);
+      _exit (0);
+    }
+
+  close (fds[1]);
+  std::string line;
+  char buffer[256];
+  ssize_t n;
+  while ((n = read (fds[0], buffer, sizeof (buffer))) > 0)
+    {
+      line.append (buffer, n);
+    }
+  close (fds[0]);
+
+  int status = 0;
+  waitpid (pid, &status, 0);
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0 || line.empty ())
+    {
+      NS_LOG_ERROR ("Run with " << clients << " clients failed");
+      return "";
+    }
+  return line;
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.topology = "dumbbell";
+  config.servers = 1;
+  config.branches = 4;
+  config.bottleneckRate = "1Gbps";
+  config.accessRate = "100Mbps";
+  config.stagger = 0.001;
+  config.stopTime = 12;
+  config.fileName = "./scratch/frame.txt";
+  config.packetPoolSize = 0;
+  std::string counts = "1,10,100";
+  std::string output = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("counts", "Comma separated client counts to run", counts);
+  cmd.AddValue ("topology", "dumbbell or tree", config.topology);
+  cmd.AddValue ("servers", "Number of RTSP servers", config.servers);
+  cmd.AddValue ("branches", "Number of branch routers of the tree topology", config.branches);
+  cmd.AddValue ("bottleneckRate", "Bottleneck link rate", config.bottleneckRate);
+  cmd.AddValue ("accessRate", "Access link rate", config.accessRate);
+  cmd.AddValue ("stagger", "Seconds between the SETUPs of consecutive clients", config.stagger);
+  cmd.AddValue ("stopTime", "Stop time of the applications in seconds", config.stopTime);
+  cmd.AddValue ("fileName", "Frame trace streamed to every client", config.fileName);
+  cmd.AddValue ("packetPoolSize", "PacketPoolSize of the servers, 0 disables the RTP packet pool", config.packetPoolSize);
+  cmd.AddValue ("output", "CSV output file, empty for stdout", output);
+  cmd.Parse (argc, argv);
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str (), std::ios::trunc);
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Failed to open " << output);
+        }
+    }
+  std::ostream &out = output.empty () ? std::cout : file;
+
+  out << "clients,simSeconds,streamSeconds,wallSeconds,events,peakRssKb,"
+      << "eventsPerSimSecond,wallUsPerStreamSecond,goodputMbps" << std::endl;
+
+  std::istringstream list (counts);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      uint32_t clients = std::stoul (item);
+      if (clients == 0)
+        {
+          continue;
+        }
+      std::string line = RunInChild (config, clients);
+      if (!line.empty ())
+        {
+          out << line << std::endl;
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+// dumbbell:
+//   servers -- r0 ===== r1 -- clients
+//
+// tree:
+//                 +== r1 -- clients
+//   servers -- r0 +== r2 -- clients
+//                 +== ...
+//
+// - N clients stream from M servers over shared bottleneck links
+// - SETUP/PLAY of the clients are staggered by --stagger
+//
+// ./waf --run "RtspScenario --clients=100 --servers=4 --topology=tree --branches=4"
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/rtsp-scenario-helper.h"
+#include "ns3/rtsp-stats-collector.h"
+#include "ns3/rtsp-tick-driver.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RtspScenario");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t clients = 10;
+  uint32_t servers = 1;
+  uint32_t branches = 2;
+  std::string topology = "dumbbell";
+  std::string bottleneckRate = "10Mbps";
+  std::string bottleneckDelay = "20ms";
+  std::string accessRate = "100Mbps";
+  std::string accessDelay = "1ms";
+  std::string queueDisc = "";
+  double stagger = 0.01;
+  double stopTime = 20;
+  std::string fileName = "./scratch/frame.txt";
+  std::string statsFile = "rtsp-stats.csv";
+  bool tickDriver = false;
+  uint64_t memoryLimit = 0;
+
+  CommandLine cmd;
+  cmd.AddValue ("clients", "Number of RTSP clients", clients);
+  cmd.AddValue ("servers", "Number of RTSP servers", servers);
+  cmd.AddValue ("topology", "dumbbell or tree", topology);
+  cmd.AddValue ("branches", "Number of branch routers of the tree topology", branches);
+  cmd.AddValue ("bottleneckRate", "Bottleneck link rate", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "Bottleneck link delay", bottleneckDelay);
+  cmd.AddValue ("accessRate", "Access link rate", accessRate);
+  cmd.AddValue ("accessDelay", "Access link delay", accessDelay);
+  cmd.AddValue ("queueDisc", "Bottleneck queue disc type (e.g. ns3::FqCoDelQueueDisc), empty for default", queueDisc);
+  cmd.AddValue ("stagger", "Seconds between the SETUPs of consecutive clients", stagger);
+  cmd.AddValue ("stopTime", "Stop time of the applications in seconds", stopTime);
+  cmd.AddValue ("fileName", "Frame trace streamed to every client", fileName);
+  cmd.AddValue ("statsFile", "Output of the statistics collector, empty to disable", statsFile);
+  cmd.AddValue ("memoryLimit", "Per-session memory limit in bytes on servers and clients, 0 for none", memoryLimit);
+  cmd.AddValue ("tickDriver", "Run the periodic timers of all sessions from one shared event per period", tickDriver);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("RtspScenario", LOG_LEVEL_INFO);
+
+  Ptr<RtspStatsCollector> stats = CreateObject<RtspStatsCollector> ();
+  stats->SetAttribute ("FileName", StringValue (statsFile));
+
+  RtspScenarioHelper scenario;
+  scenario.SetTopology (topology == "tree" ? RtspScenarioHelper::TREE : RtspScenarioHelper::DUMBBELL);
+  scenario.SetClientCount (clients);
+  scenario.SetServerCount (servers);
+  scenario.SetTreeBranches (branches);
+  scenario.SetBottleneck (bottleneckRate, bottleneckDelay);
+  scenario.SetAccessLink (accessRate, accessDelay);
+  if (!queueDisc.empty ())
+    {
+      scenario.SetQueueDisc (queueDisc);
+    }
+  scenario.SetSchedule (Seconds (1), Seconds (stagger), Seconds (1));
+  scenario.SetStopTime (Seconds (stopTime));
+  scenario.SetServerAttribute ("StatsCollector", PointerValue (stats));
+  scenario.SetClientAttribute ("FileName", StringValue (fileName));
+  scenario.SetClientAttribute ("StatsCollector", PointerValue (stats));
+  scenario.SetServerAttribute ("SessionMemoryLimit", UintegerValue (memoryLimit));
+  scenario.SetClientAttribute ("MemoryLimit", UintegerValue (memoryLimit));
+  Ptr<RtspTickDriver> driver;
+  if (tickDriver)
+    {
+      driver = CreateObject<RtspTickDriver> ();
+      scenario.SetServerAttribute ("TickDriver", PointerValue (driver));
+      scenario.SetClientAttribute ("TickDriver", PointerValue (driver));
+    }
+  scenario.Build ();
+
+  Simulator::Run ();
+
+  uint64_t goodput = 0;
+  uint32_t stalls = 0;
+  uint64_t evicted = 0;
+  for (uint32_t i = 0; i < clients; i++)
+    {
+      goodput += scenario.GetClient (i)->GetGoodputSize ();
+      stalls += scenario.GetClient (i)->GetStallCount ();
+      evicted += scenario.GetClient (i)->GetMemoryEvictedBytes ();
+    }
+  for (uint32_t i = 0; i < servers; i++)
+    {
+      evicted += scenario.GetServer (i)->GetMemoryEvictedBytes ();
+    }
+  NS_LOG_INFO ("clients " << clients << " goodput " << goodput * 8.0 / stopTime / 1000000
+               << " Mbps stalls " << stalls << " evicted " << evicted << " bytes");
+  if (driver != 0)
+    {
+      NS_LOG_INFO ("tick events " << driver->GetTickCount ());
+    }
+
+  Simulator::Destroy ();
+}
@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// RTSP 파라미터 스윕
+//
+// error rate, bottleneck rate, UseCongestionThreshold, 전송률 제어 방식의
+// 모든 조합을 --runs 번씩 독립된 자식 프로세스에서 실행합니다.
+//
+// - 동시에 --jobs 개(기본: 코어 수)의 프로세스를 실행
+// - RNG run 번호는 --runBase + 반복 번호 (RngSeedManager::SetRun)
+//   모든 조합의 같은 반복이 같은 난수열을 쓰므로 (common random numbers) 조합 간 차이만 비교됨
+// - 결과는 조합 순서대로 하나의 CSV 표로 합쳐서 출력
+//
+// ./waf --run "RtspSweep --errorRates=0,0.01,0.05 --linkRates=2Mbps,5Mbps
+//              --controllers=ns3::RtspLevelRateController,ns3::RtspGccRateController
+//              --runs=3 --output=sweep.csv"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/error-model.h"
+#include "ns3/rtsp-scenario-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RtspSweep");
+
+//조합 하나
+struct SweepPoint
+{
+  uint32_t index;                //출력 순서
+  double errorRate;
+  std::string linkRate;
+  bool useThreshold;
+  std::string controller;
+  uint32_t run;                  //반복 번호, RNG run 번호를 정함
+};
+
+struct SweepConfig
+{
+  uint32_t clients;
+  double stopTime;
+  std::string fileName;
+  uint32_t runBase;
+};
+
+static std::vector<std::string>
+Split (const std::string &list)
+{
+  std::vector<std::string> items;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+//조합 하나를 실행하고 결과 열을 CSV로 반환
+static std::string
+RunPoint (const SweepConfig &config, const SweepPoint &point)
+{
+  RngSeedManager::SetRun (config.runBase + point.run);
+
+  RtspScenarioHelper scenario;
+  scenario.SetClientCount (config.clients);
+  scenario.SetBottleneck (point.linkRate, "10us");
+  scenario.SetSchedule (Seconds (2), MilliSeconds (10), Seconds (1));
+  scenario.SetStopTime (Seconds (config.stopTime));
+  scenario.SetServerAttribute ("RateController", TypeIdValue (TypeId::LookupByName (point.controller)));
+  scenario.SetServerAttribute ("UseCongestionThreshold", BooleanValue (point.useThreshold));
+  scenario.SetClientAttribute ("FileName", StringValue (config.fileName));
+  scenario.Build ();
+
+  //RtspTest와 같이 수신 쪽 장치에 packet 단위 손실 적용
+  if (point.errorRate > 0)
+    {
+      NetDeviceContainer devices = scenario.GetBottleneckDevices ();
+      for (uint32_t i = 1; i < devices.GetN (); i += 2)
+        {
+          Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+          em->SetAttribute ("ErrorRate", DoubleValue (point.errorRate));
+          em->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+          devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+        }
+    }
+
+  Simulator::Run ();
+
+  uint64_t goodput = 0;
+  uint32_t decoded = 0;
+  uint32_t stalls = 0;
+  double rebuffer = 0;
+  double fractionLost = 0;
+  for (uint32_t i = 0; i < config.clients; i++)
+    {
+      Ptr<RtspClient> client = scenario.GetClient (i);
+      goodput += client->GetGoodputSize ();
+      decoded += client->GetDecodedFrames ();
+      stalls += client->GetStallCount ();
+      rebuffer += client->GetRebufferRatio ();
+      fractionLost += client->GetFractionLost ();
+    }
+  Simulator::Destroy ();
+
+  std::ostringstream line;
+  line << goodput * 8.0 / config.stopTime / 1e6 << ',' << decoded << ',' << stalls << ','
+       << rebuffer / config.clients << ',' << fractionLost / config.clients;
+  return line.str ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  SweepConfig config;
+  config.clients = 1;
+  config.stopTime = 20;
+  config.fileName = "./scratch/frame.txt";
+  config.runBase = 1;
+  std::string errorRates = "0,0.1";
+  std::string linkRates = "5Mbps";
+  std::string thresholds = "1";
+  std::string controllers = "ns3::RtspLevelRateController";
+  uint32_t runs = 1;
+  long cores = sysconf (_SC_NPROCESSORS_ONLN);
+  uint32_t jobs = cores > 0 ? cores : 1;
+  std::string output = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("errorRates", "Comma separated packet error rates", errorRates);
+  cmd.AddValue ("linkRates", "Comma separated bottleneck rates", linkRates);
+  cmd.AddValue ("thresholds", "Comma separated UseCongestionThreshold values (0/1)", thresholds);
+  cmd.AddValue ("controllers", "Comma separated RtspRateController TypeIds", controllers);
+  cmd.AddValue ("runs", "Independent runs per combination", runs);
+  cmd.AddValue ("runBase", "RNG run number of the first run of every combination", config.runBase);
+  cmd.AddValue ("clients", "Number of RTSP clients per simulation", config.clients);
+  cmd.AddValue ("stopTime", "Stop time of the applications in seconds", config.stopTime);
+  cmd.AddValue ("fileName", "Frame trace streamed to every client", config.fileName);
+  cmd.AddValue ("jobs", "Simulations run at the same time", jobs);
+  cmd.AddValue ("output", "CSV output file, empty for stdout", output);
+  cmd.Parse (argc, argv);
+  jobs = std::max (jobs, 1u);
+
+  //모든 조합 생성
+  std::vector<SweepPoint> points;
+  for (const std::string &errorRate : Split (errorRates))
+    for (const std::string &linkRate : Split (linkRates))
+      for (const std::string &threshold : Split (thresholds))
+        for (const std::string &controller : Split (controllers))
+          for (uint32_t run = 0; run < runs; run++)
+            {
+              SweepPoint point;
+              point.index = points.size ();
+              point.errorRate = std::stod (errorRate);
+              point.linkRate = linkRate;
+              point.useThreshold = threshold != "0" && threshold != "false";
+              point.controller = controller;
+              point.run = run;
+              points.push_back (point);
+            }
+  NS_LOG_UNCOND ("RtspSweep: " << points.size () << " simulations on " << jobs << " processes");
+
+  //조합마다 자식 프로세스 하나, 결과는 파이프로 받음
+  //결과 한 줄은 PIPE_BUF보다 작아서 자식이 부모를 기다리지 않고 종료할 수 있음
+  std::vector<std::string> results (points.size ());
+  std::map<pid_t, std::pair<uint32_t, int> > running;
+  uint32_t next = 0;
+  while (next < points.size () || !running.empty ())
+    {
+      while (next < points.size () && running.size () < jobs)
+        {
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("pipe failed");
+            }
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("fork failed");
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string line = RunPoint (config, points[next]);
+              ssize_t written = write (fds[1], line.data (), line.size ());
+              NS_UNUSED (written);
+              close (fds[1]);
+              _exit (0);
+            }
+          close (fds[1]);
+          running[pid] = std::make_pair (next, fds[0]);
+          next++;
+        }
+
+      int status = 0;
+      pid_t pid = wait (&status);
+      auto it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      uint32_t index = it->second.first;
+      int fd = it->second.second;
+      char buffer[256];
+      ssize_t n;
+      while ((n = read (fd, buffer, sizeof (buffer))) > 0)
+        {
+          results[index].append (buffer, n);
+        }
+      close (fd);
+      running.erase (it);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_ERROR ("Simulation " << index << " failed");
+          results[index].clear ();
+        }
+    }
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str (), std::ios::trunc);
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Failed to open " << output);
+        }
+    }
+  std::ostream &out = output.empty () ? std::cout : file;
+
+  out << "index,errorRate,linkRate,useCongestionThreshold,controller,run,rngRun,"
+      << "goodputMbps,decodedFrames,stalls,rebufferRatio,fractionLost" << std::endl;
+  for (const SweepPoint &point : points)
+    {
+      out << point.index << ',' << point.errorRate << ',' << point.linkRate << ','
+          << point.useThreshold << ',' << point.controller << ',' << point.run << ','
+          << config.runBase + point.run << ','
+          << (results[point.index].empty () ? "failed,,,," : results[point.index]) << std::endl;
+    }
+  return 0;
+}
@@ -37,18 +37,6 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("RtspTest");
 
-void CalculateThroughput(const Ptr<RtspClient> client)
-{
-  if(Simulator::IsFinished() || Simulator::Now().GetSeconds() > 21) return;
-
-  static uint64_t lastRx = 0;
-  uint64_t curRx = client->GetRxSize();
-
-  NS_LOG_INFO(Simulator::Now().GetSeconds() <<' '<<(curRx - lastRx) * 80.0 / 1000000 );
-  lastRx = curRx;
-  Simulator::Schedule(MilliSeconds(100), CalculateThroughput, client);
-}
-
 // void OnChangeFractionLoss(float& fractionLoss)
 // {
 //   NS_LOG_INFO(Simulator::Now().GetSeconds() <<' '<<fractionLoss * 100);
@@ -85,7 +73,13 @@ main (int argc, char *argv[])
   clientAddress = Address (i.GetAddress (0));
   serverAddress = Address (i.GetAddress (1));
 
+  //모든 클라이언트/서버 세션의 카운터를 100ms마다 rtsp-stats.csv에 기록
+  Ptr<RtspStatsCollector> stats = CreateObject<RtspStatsCollector> ();
+  stats->SetAttribute("FileName", StringValue("rtsp-stats.csv"));
+  stats->SetAttribute("Interval", TimeValue(MilliSeconds(100)));
+
   RtspServerHelper server(serverAddress);
+  server.SetAttribute("StatsCollector", PointerValue(stats));
   ApplicationContainer apps = server.Install (n.Get (1));
   server.SetAttribute("UseCongestionThreshold", BooleanValue(true));
 
@@ -97,6 +91,7 @@ main (int argc, char *argv[])
 
   RtspClientHelper client(serverAddress, clientAddress);
   client.SetAttribute ("FileName", StringValue ("./scratch/frame.txt")); // set File name
+  client.SetAttribute ("StatsCollector", PointerValue (stats));
   apps = client.Install (n.Get (0));
 
   //manually set message
@@ -120,8 +115,6 @@ main (int argc, char *argv[])
   em->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
   d.Get (0)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
 
-  Simulator::Schedule(MilliSeconds(100), CalculateThroughput, rtspClient);
-
   // Now, do the actual simulation.
   Simulator::Run ();
   Simulator::Stop(Seconds(30.0));
@@ -100,4 +100,11 @@ RtspClientHelper::Install (NodeContainer c)
   return apps;
 }
 
+void
+RtspClientHelper::ScheduleMessage (Time time, RtspClient::Method_t requestMethod)
+{
+  NS_ASSERT_MSG (m_client != 0, "No client has been installed yet");
+  m_client->ScheduleMessage (time, requestMethod);
+}
+
 } // namespace ns3
@@ -131,6 +131,12 @@ public:
      */
   ApplicationContainer Install (NodeContainer c);
 
+  /**
+   * Schedule an RTSP request on the last created client.
+   *
+   * \param time the time at which the request is sent
+   * \param requestMethod the RTSP method of the request
+   */
   void ScheduleMessage(Time time, RtspClient::Method_t requestMethod);
 
 private:
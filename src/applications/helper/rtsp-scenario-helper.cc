@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "rtsp-scenario-helper.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("RtspScenarioHelper");
+
+namespace ns3 {
+
+RtspScenarioHelper::RtspScenarioHelper ()
+  : m_topology (DUMBBELL),
+    m_clientCount (1),
+    m_serverCount (1),
+    m_branches (2),
+    m_systemCount (1),
+    m_hasQueueDisc (false),
+    m_setupStart (Seconds (1)),
+    m_setupInterval (MilliSeconds (10)),
+    m_playDelay (Seconds (1)),
+    m_stopTime (Seconds (20)),
+    m_multicastGroup (Ipv4Address::GetAny ())
+{
+  SetBottleneck ("10Mbps", "20ms");
+  SetAccessLink ("100Mbps", "1ms");
+}
+
+void
+RtspScenarioHelper::SetTopology (Topology_t topology)
+{
+  m_topology = topology;
+}
+
+void
+RtspScenarioHelper::SetClientCount (uint32_t clients)
+{
+  m_clientCount = clients;
+}
+
+void
+RtspScenarioHelper::SetServerCount (uint32_t servers)
+{
+  NS_ASSERT (servers > 0);
+  m_serverCount = servers;
+}
+
+void
+RtspScenarioHelper::SetTreeBranches (uint32_t branches)
+{
+  NS_ASSERT (branches > 0);
+  m_branches = branches;
+}
+
+void
+RtspScenarioHelper::SetSystemCount (uint32_t systems)
+{
+  NS_ASSERT (systems > 0);
+  m_systemCount = systems;
+}
+
+uint32_t
+RtspScenarioHelper::GetBranchSystemId (uint32_t b) const
+{
+  return m_systemCount > 1 ? 1 + b % (m_systemCount - 1) : 0;
+}
+
+void
+RtspScenarioHelper::SetBottleneck (std::string dataRate, std::string delay)
+{
+  m_bottleneck.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_bottleneck.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+RtspScenarioHelper::SetAccessLink (std::string dataRate, std::string delay)
+{
+  m_access.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_access.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+RtspScenarioHelper::SetQueueDisc (std::string type,
+                                  std::string n1, const AttributeValue &v1,
+                                  std::string n2, const AttributeValue &v2)
+{
+  m_queueDisc = TrafficControlHelper ();
+  m_queueDisc.SetRootQueueDisc (type, n1, v1, n2, v2);
+  m_hasQueueDisc = true;
+}
+
+void
+RtspScenarioHelper::SetSchedule (Time setupStart, Time setupInterval, Time playDelay)
+{
+  m_setupStart = setupStart;
+  m_setupInterval = setupInterval;
+  m_playDelay = playDelay;
+}
+
+void
+RtspScenarioHelper::SetStopTime (Time stop)
+{
+  m_stopTime = stop;
+}
+
+void
+RtspScenarioHelper::SetServerAttribute (std::string name, const AttributeValue &value)
+{
+  //multicast 경로를 설치하려면 그룹 주소를 알아야 함 (StringValue로 줘도 읽을 수 있게 문자열로 변환)
+  if (name == "MulticastGroup")
+    {
+      Ipv4AddressValue group;
+      if (!group.DeserializeFromString (value.SerializeToString (MakeIpv4AddressChecker ()),
+                                        MakeIpv4AddressChecker ()))
+        {
+          NS_FATAL_ERROR ("Invalid server MulticastGroup");
+        }
+      m_multicastGroup = group.Get ();
+    }
+  m_serverHelper.SetAttribute (name, value);
+}
+
+void
+RtspScenarioHelper::SetClientAttribute (std::string name, const AttributeValue &value)
+{
+  m_clientHelper.SetAttribute (name, value);
+}
+
+void
+RtspScenarioHelper::Build (void)
+{
+  NS_LOG_FUNCTION (this << m_clientCount << m_serverCount);
+
+  //서버와 루트 라우터는 system 0, 브랜치와 그 클라이언트는 브랜치의 system
+  uint32_t branches = m_topology == TREE ? m_branches : 1;
+  m_servers.Create (m_serverCount, 0);
+  m_routers.Create (1, 0);
+  for (uint32_t b = 0; b < branches; b++)
+    {
+      m_routers.Create (1, GetBranchSystemId (b));
+    }
+  for (uint32_t i = 0; i < m_clientCount; i++)
+    {
+      m_clients.Create (1, GetBranchSystemId (i % branches));
+    }
+
+  //호스트 접속 링크는 (호스트, 라우터) 순서, 주소는 0번 장치에서 읽음
+  std::vector<NetDeviceContainer> serverLinks;
+  std::vector<NetDeviceContainer> clientLinks;
+  std::vector<NetDeviceContainer> bottleneckLinks;
+  Ptr<Node> root = m_routers.Get (0);
+  for (uint32_t i = 0; i < m_serverCount; i++)
+    {
+      serverLinks.push_back (m_access.Install (m_servers.Get (i), root));
+    }
+  for (uint32_t b = 0; b < branches; b++)
+    {
+      bottleneckLinks.push_back (m_bottleneck.Install (root, m_routers.Get (1 + b)));
+      m_bottleneckDevices.Add (bottleneckLinks.back ());
+    }
+  for (uint32_t i = 0; i < m_clientCount; i++)
+    {
+      clientLinks.push_back (m_access.Install (m_clients.Get (i), m_routers.Get (1 + i % branches)));
+    }
+
+  InternetStackHelper internet;
+  internet.Install (m_routers);
+  internet.Install (m_servers);
+  internet.Install (m_clients);
+
+  //주소를 붙이기 전에 설치해야 기본 queue disc 대신 사용됨
+  if (m_hasQueueDisc)
+    {
+      m_queueDisc.Install (m_bottleneckDevices);
+    }
+
+  //링크마다 /30 서브넷 하나
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  std::vector<Ipv4Address> serverAddresses;
+  for (auto &link : serverLinks)
+    {
+      serverAddresses.push_back (address.Assign (link).GetAddress (0));
+      address.NewNetwork ();
+    }
+  for (auto &link : bottleneckLinks)
+    {
+      address.Assign (link);
+      address.NewNetwork ();
+    }
+  std::vector<Ipv4Address> clientAddresses;
+  for (auto &link : clientLinks)
+    {
+      clientAddresses.push_back (address.Assign (link).GetAddress (0));
+      address.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  if (m_multicastGroup != Ipv4Address::GetAny ())
+    {
+      InstallMulticastRoutes (serverLinks, bottleneckLinks, clientLinks, serverAddresses);
+    }
+
+  //애플리케이션은 이 프로세스가 맡은 노드에만 설치
+  const uint32_t localSystem = Simulator::GetSystemId ();
+  m_serverList.assign (m_serverCount, 0);
+  for (uint32_t i = 0; i < m_serverCount; i++)
+    {
+      if (m_servers.Get (i)->GetSystemId () != localSystem)
+        {
+          continue;
+        }
+      m_serverHelper.SetAttribute ("LocalAddress", AddressValue (serverAddresses[i]));
+      if (m_multicastGroup != Ipv4Address::GetAny ())
+        {
+          m_serverHelper.SetAttribute ("MulticastGroup", Ipv4AddressValue (GetMulticastGroup (i)));
+        }
+      ApplicationContainer apps = m_serverHelper.Install (m_servers.Get (i));
+      m_serverList[i] = DynamicCast<RtspServer> (apps.Get (0));
+      m_serverApps.Add (apps);
+    }
+  m_serverApps.Start (Seconds (0));
+  m_serverApps.Stop (m_stopTime);
+
+  m_clientList.assign (m_clientCount, 0);
+  for (uint32_t i = 0; i < m_clientCount; i++)
+    {
+      if (m_clients.Get (i)->GetSystemId () != localSystem)
+        {
+          continue;
+        }
+      m_clientHelper.SetAttribute ("RemoteAddress", AddressValue (serverAddresses[i % m_serverCount]));
+      m_clientHelper.SetAttribute ("LocalAddress", AddressValue (clientAddresses[i]));
+      ApplicationContainer apps = m_clientHelper.Install (m_clients.Get (i));
+
+      Ptr<RtspClient> client = DynamicCast<RtspClient> (apps.Get (0));
+      Time setup = m_setupStart + m_setupInterval * double (i);
+      client->ScheduleMessage (setup, RtspClient::SETUP);
+      client->ScheduleMessage (setup + m_playDelay, RtspClient::PLAY);
+      m_clientList[i] = client;
+      m_clientApps.Add (apps);
+    }
+  m_clientApps.Start (Seconds (0));
+  m_clientApps.Stop (m_stopTime);
+
+  NS_LOG_INFO ("Built " << (m_topology == TREE ? "tree" : "dumbbell") << " with "
+               << m_clientCount << " clients, " << m_serverCount << " servers and "
+               << branches << " bottleneck links on system " << localSystem << " ("
+               << m_clientApps.GetN () << " local clients, " << m_serverApps.GetN () << " local servers)");
+}
+
+Ipv4Address
+RtspScenarioHelper::GetMulticastGroup (uint32_t i) const
+{
+  //서버마다 다른 그룹을 써야 같은 브랜치의 다른 서버 클라이언트가 섞여 받지 않음
+  Ipv4Address group (m_multicastGroup.Get () + i);
+  NS_ASSERT_MSG (group.IsMulticast (), "Multicast group range exhausted at " << group);
+  return group;
+}
+
+//global routing은 multicast를 다루지 않으므로 서버 i의 그룹을 정적 경로로 전달
+//서버는 기본 multicast 경로로 접속 링크에 내보내고, 루트 라우터는 그 서버의 클라이언트가 있는
+//브랜치의 병목 링크로, 브랜치 라우터는 그 클라이언트들의 접속 링크로만 복제
+void
+RtspScenarioHelper::InstallMulticastRoutes (const std::vector<NetDeviceContainer> &serverLinks,
+                                            const std::vector<NetDeviceContainer> &bottleneckLinks,
+                                            const std::vector<NetDeviceContainer> &clientLinks,
+                                            const std::vector<Ipv4Address> &serverAddresses)
+{
+  NS_LOG_FUNCTION (this << m_multicastGroup);
+
+  Ipv4StaticRoutingHelper staticRouting;
+  Ptr<Node> root = m_routers.Get (0);
+  const uint32_t branches = bottleneckLinks.size ();
+  for (uint32_t s = 0; s < m_serverCount; s++)
+    {
+      Ipv4Address group = GetMulticastGroup (s);
+      staticRouting.SetDefaultMulticastRoute (m_servers.Get (s), serverLinks[s].Get (0));
+
+      NetDeviceContainer rootOutputs;
+      for (uint32_t b = 0; b < branches; b++)
+        {
+          NetDeviceContainer branchOutputs;
+          for (uint32_t i = b; i < m_clientCount; i += branches)
+            {
+              if (i % m_serverCount == s)
+                {
+                  branchOutputs.Add (clientLinks[i].Get (1));
+                }
+            }
+          if (branchOutputs.GetN () == 0)
+            {
+              continue;
+            }
+          rootOutputs.Add (bottleneckLinks[b].Get (0));
+          staticRouting.AddMulticastRoute (m_routers.Get (1 + b), serverAddresses[s], group,
+                                           bottleneckLinks[b].Get (1), branchOutputs);
+        }
+      if (rootOutputs.GetN () > 0)
+        {
+          staticRouting.AddMulticastRoute (root, serverAddresses[s], group, serverLinks[s].Get (1), rootOutputs);
+        }
+      NS_LOG_INFO ("Multicast group " << group << " of server " << s << " routed to "
+                   << rootOutputs.GetN () << " branches");
+    }
+}
+
+NodeContainer
+RtspScenarioHelper::GetClients (void) const
+{
+  return m_clients;
+}
+
+NodeContainer
+RtspScenarioHelper::GetServers (void) const
+{
+  return m_servers;
+}
+
+NodeContainer
+RtspScenarioHelper::GetRouters (void) const
+{
+  return m_routers;
+}
+
+ApplicationContainer
+RtspScenarioHelper::GetClientApps (void) const
+{
+  return m_clientApps;
+}
+
+ApplicationContainer
+RtspScenarioHelper::GetServerApps (void) const
+{
+  return m_serverApps;
+}
+
+NetDeviceContainer
+RtspScenarioHelper::GetBottleneckDevices (void) const
+{
+  return m_bottleneckDevices;
+}
+
+Ptr<RtspClient>
+RtspScenarioHelper::GetClient (uint32_t i) const
+{
+  NS_ASSERT (i < m_clientList.size ());
+  return m_clientList[i];
+}
+
+Ptr<RtspServer>
+RtspScenarioHelper::GetServer (uint32_t i) const
+{
+  NS_ASSERT (i < m_serverList.size ());
+  return m_serverList[i];
+}
+
+} // namespace ns3
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef RTSP_SCENARIO_HELPER_H
+#define RTSP_SCENARIO_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/rtsp-client-server-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpclientserver
+ * \brief Build an RTSP scenario with N clients and M servers.
+ *
+ * Dumbbell: servers -- left router == bottleneck == right router -- clients
+ *
+ * Tree:     servers -- root router == bottleneck == branch router -- clients
+ *           (one bottleneck link per branch, clients spread round robin)
+ *
+ * Every host hangs off its router through its own access link. Client i
+ * streams from server i % M. Its SETUP is sent at
+ * setupStart + i * setupInterval and its PLAY playDelay later.
+ *
+ * If the server MulticastGroup attribute is set, server i uses group
+ * MulticastGroup + i for the one content its clients request, and static
+ * multicast routes carry it from the server through the routers to
+ * exactly the access links of its clients (ns-3 has no IGMP/PIM).
+ *
+ * For distributed simulation the servers and the root router live on
+ * system 0, and branch b with its clients on system 1 + b % (systems - 1).
+ * Only the bottleneck links cross systems, so their delay is the
+ * lookahead. Applications are installed on the local system's nodes only.
+ */
+class RtspScenarioHelper
+{
+public:
+  enum Topology_t
+  {
+    DUMBBELL,
+    TREE,
+  };
+
+  RtspScenarioHelper ();
+
+  void SetTopology (Topology_t topology);
+  void SetClientCount (uint32_t clients);
+  void SetServerCount (uint32_t servers);
+  /**
+   * \param branches number of branch routers of the tree topology
+   */
+  void SetTreeBranches (uint32_t branches);
+  /**
+   * \param systems number of MPI ranks to partition the nodes over,
+   *        1 for a sequential simulation
+   */
+  void SetSystemCount (uint32_t systems);
+
+  /**
+   * \param dataRate rate of every bottleneck link, e.g. "10Mbps"
+   * \param delay propagation delay of every bottleneck link, e.g. "20ms"
+   */
+  void SetBottleneck (std::string dataRate, std::string delay);
+  /**
+   * \param dataRate rate of every host access link
+   * \param delay propagation delay of every host access link
+   */
+  void SetAccessLink (std::string dataRate, std::string delay);
+  /**
+   * Install a root queue disc of the given type on the bottleneck devices
+   * instead of the default one.
+   */
+  void SetQueueDisc (std::string type,
+                     std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                     std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
+  /**
+   * \param setupStart time of the first SETUP
+   * \param setupInterval gap between the SETUPs of consecutive clients
+   * \param playDelay gap between the SETUP and the PLAY of each client
+   */
+  void SetSchedule (Time setupStart, Time setupInterval, Time playDelay);
+  void SetStopTime (Time stop);
+
+  /**
+   * Record an attribute to be set in each server / client application.
+   * A server MulticastGroup is also used to install the multicast routes.
+   */
+  void SetServerAttribute (std::string name, const AttributeValue &value);
+  void SetClientAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create the nodes, links, addresses, routes and applications.
+   */
+  void Build (void);
+
+  NodeContainer GetClients (void) const;
+  NodeContainer GetServers (void) const;
+  NodeContainer GetRouters (void) const;
+  ApplicationContainer GetClientApps (void) const;
+  ApplicationContainer GetServerApps (void) const;
+  /**
+   * \returns the devices of every bottleneck link, router side first
+   */
+  NetDeviceContainer GetBottleneckDevices (void) const;
+  /**
+   * \returns client i, or 0 if it runs on another system
+   */
+  Ptr<RtspClient> GetClient (uint32_t i) const;
+  /**
+   * \returns server i, or 0 if it runs on another system
+   */
+  Ptr<RtspServer> GetServer (uint32_t i) const;
+  /**
+   * \returns the system that runs branch b (and its clients)
+   */
+  uint32_t GetBranchSystemId (uint32_t b) const;
+
+private:
+  /**
+   * \returns the multicast group of server i
+   */
+  Ipv4Address GetMulticastGroup (uint32_t i) const;
+  /**
+   * Install static routes carrying each server's multicast group to its
+   * clients. Links are (host, router) or (root, branch router) pairs.
+   */
+  void InstallMulticastRoutes (const std::vector<NetDeviceContainer> &serverLinks,
+                               const std::vector<NetDeviceContainer> &bottleneckLinks,
+                               const std::vector<NetDeviceContainer> &clientLinks,
+                               const std::vector<Ipv4Address> &serverAddresses);
+
+  Topology_t m_topology;                //!< Dumbbell or tree
+  uint32_t m_clientCount;               //!< Number of clients
+  uint32_t m_serverCount;               //!< Number of servers
+  uint32_t m_branches;                  //!< Branch routers of the tree
+  uint32_t m_systemCount;               //!< MPI ranks the nodes are spread over
+  PointToPointHelper m_bottleneck;      //!< Bottleneck link helper
+  PointToPointHelper m_access;          //!< Access link helper
+  TrafficControlHelper m_queueDisc;     //!< Bottleneck queue disc helper
+  bool m_hasQueueDisc;                  //!< Whether SetQueueDisc was called
+  Time m_setupStart;                    //!< SETUP time of the first client
+  Time m_setupInterval;                 //!< SETUP gap between clients
+  Time m_playDelay;                     //!< PLAY after SETUP
+  Time m_stopTime;                      //!< Stop time of every application
+  Ipv4Address m_multicastGroup;         //!< Server MulticastGroup, any if unset
+
+  RtspServerHelper m_serverHelper;      //!< Server application helper
+  RtspClientHelper m_clientHelper;      //!< Client application helper
+
+  NodeContainer m_clients;              //!< Client nodes
+  NodeContainer m_servers;              //!< Server nodes
+  NodeContainer m_routers;              //!< Router nodes
+  NetDeviceContainer m_bottleneckDevices; //!< Bottleneck devices
+  ApplicationContainer m_clientApps;    //!< Local client applications
+  ApplicationContainer m_serverApps;    //!< Local server applications
+  std::vector<Ptr<RtspClient> > m_clientList; //!< Client i, 0 if remote
+  std::vector<Ptr<RtspServer> > m_serverList; //!< Server i, 0 if remote
+};
+
+} // namespace ns3
+
+#endif /* RTSP_SCENARIO_HELPER_H */
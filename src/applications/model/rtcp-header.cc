@@ -0,0 +1,473 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtcp-header.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ns3/log.h>
+#include <ns3/unused.h>
+
+NS_LOG_COMPONENT_DEFINE("RtcpHeader");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RtcpCommonHeader);
+NS_OBJECT_ENSURE_REGISTERED(RtcpReceiverReportHeader);
+NS_OBJECT_ENSURE_REGISTERED(RtcpNackHeader);
+
+static const uint8_t RTCP_VERSION = 2;
+
+RtcpCommonHeader::RtcpCommonHeader ()
+  : m_count (0),
+    m_packetType (0),
+    m_length (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint8_t
+RtcpCommonHeader::GetCount (void) const
+{
+  return m_count;
+}
+
+uint8_t
+RtcpCommonHeader::GetPacketType (void) const
+{
+  return m_packetType;
+}
+
+uint32_t
+RtcpCommonHeader::GetPacketSize (void) const
+{
+  return ((uint32_t) m_length + 1) * 4;
+}
+
+TypeId
+RtcpCommonHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtcpCommonHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtcpCommonHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtcpCommonHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtcpCommonHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(RTCP pt=" << (uint32_t) m_packetType << " count=" << (uint32_t) m_count
+     << " size=" << GetPacketSize () << ")";
+}
+
+uint32_t
+RtcpCommonHeader::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+RtcpCommonHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 ((RTCP_VERSION << 6) | (m_count & 0x1f));
+  i.WriteU8 (m_packetType);
+  i.WriteHtonU16 (m_length);
+}
+
+uint32_t
+RtcpCommonHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint8_t byte = i.ReadU8 ();
+  NS_ASSERT_MSG ((byte >> 6) == RTCP_VERSION, "Unexpected RTCP version " << (byte >> 6));
+  m_count = byte & 0x1f;
+  m_packetType = i.ReadU8 ();
+  m_length = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+RtcpReceiverReportHeader::RtcpReceiverReportHeader ()
+  : m_senderSsrc (0),
+    m_sourceSsrc (0),
+    m_fractionLost (0),
+    m_cumulativeLost (0),
+    m_highestSeq (0),
+    m_jitter (0),
+    m_lsr (0),
+    m_dlsr (0),
+    m_oneWayDelay (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtcpReceiverReportHeader::SetSenderSsrc (uint32_t ssrc)
+{
+  m_senderSsrc = ssrc;
+}
+
+uint32_t
+RtcpReceiverReportHeader::GetSenderSsrc (void) const
+{
+  return m_senderSsrc;
+}
+
+void
+RtcpReceiverReportHeader::SetSourceSsrc (uint32_t ssrc)
+{
+  m_sourceSsrc = ssrc;
+}
+
+uint32_t
+RtcpReceiverReportHeader::GetSourceSsrc (void) const
+{
+  return m_sourceSsrc;
+}
+
+void
+RtcpReceiverReportHeader::SetFractionLost (double fractionLost)
+{
+  fractionLost = std::min (std::max (fractionLost, 0.0), 1.0);
+  m_fractionLost = std::min<uint32_t> (255, std::lround (fractionLost * 256));
+}
+
+double
+RtcpReceiverReportHeader::GetFractionLost (void) const
+{
+  return m_fractionLost / 256.0;
+}
+
+void
+RtcpReceiverReportHeader::SetCumulativeLost (int32_t lost)
+{
+  //24비트 부호 있는 값으로 제한
+  m_cumulativeLost = std::min (std::max (lost, -0x800000), 0x7fffff);
+}
+
+int32_t
+RtcpReceiverReportHeader::GetCumulativeLost (void) const
+{
+  return m_cumulativeLost;
+}
+
+void
+RtcpReceiverReportHeader::SetHighestSeq (uint32_t seq)
+{
+  m_highestSeq = seq;
+}
+
+uint32_t
+RtcpReceiverReportHeader::GetHighestSeq (void) const
+{
+  return m_highestSeq;
+}
+
+void
+RtcpReceiverReportHeader::SetJitter (Time jitter)
+{
+  m_jitter = std::min<int64_t> (std::max<int64_t> (jitter.GetMicroSeconds (), 0), 0xffffffff);
+}
+
+Time
+RtcpReceiverReportHeader::GetJitter (void) const
+{
+  return MicroSeconds (m_jitter);
+}
+
+void
+RtcpReceiverReportHeader::SetLastSr (Time lsr)
+{
+  m_lsr = TimeToCompact (lsr);
+}
+
+Time
+RtcpReceiverReportHeader::GetLastSr (void) const
+{
+  return CompactToTime (m_lsr);
+}
+
+void
+RtcpReceiverReportHeader::SetDelaySinceLastSr (Time dlsr)
+{
+  m_dlsr = TimeToCompact (dlsr);
+}
+
+Time
+RtcpReceiverReportHeader::GetDelaySinceLastSr (void) const
+{
+  return CompactToTime (m_dlsr);
+}
+
+void
+RtcpReceiverReportHeader::SetOneWayDelay (Time delay)
+{
+  m_oneWayDelay = std::min<int64_t> (std::max<int64_t> (delay.GetMicroSeconds (), 0), 0xffffffff);
+}
+
+Time
+RtcpReceiverReportHeader::GetOneWayDelay (void) const
+{
+  return MicroSeconds (m_oneWayDelay);
+}
+
+Time
+RtcpReceiverReportHeader::GetRoundTripTime (Time now) const
+{
+  //LSR이 없으면 RTT를 알 수 없음
+  if (m_lsr == 0)
+    {
+      return Time (0);
+    }
+  //RFC 3550처럼 32비트 모듈러 연산
+  uint32_t rtt = TimeToCompact (now) - m_lsr - m_dlsr;
+  return CompactToTime (rtt);
+}
+
+uint32_t
+RtcpReceiverReportHeader::TimeToCompact (Time time)
+{
+  return (uint32_t) ((time.GetMicroSeconds () << 16) / 1000000);
+}
+
+Time
+RtcpReceiverReportHeader::CompactToTime (uint32_t compact)
+{
+  return MicroSeconds (((uint64_t) compact * 1000000) >> 16);
+}
+
+TypeId
+RtcpReceiverReportHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtcpReceiverReportHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtcpReceiverReportHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtcpReceiverReportHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtcpReceiverReportHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(RR ssrc=" << m_senderSsrc << " source=" << m_sourceSsrc
+     << " fraction=" << GetFractionLost () << " cumLost=" << m_cumulativeLost
+     << " highestSeq=" << m_highestSeq << " jitter=" << m_jitter << "us"
+     << " lsr=" << m_lsr << " dlsr=" << m_dlsr << " owd=" << m_oneWayDelay << "us)";
+}
+
+uint32_t
+RtcpReceiverReportHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 24 + 4;
+}
+
+void
+RtcpReceiverReportHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 ((RTCP_VERSION << 6) | 1);
+  i.WriteU8 (PT_RR);
+  i.WriteHtonU16 (GetSerializedSize () / 4 - 1);
+  i.WriteHtonU32 (m_senderSsrc);
+  i.WriteHtonU32 (m_sourceSsrc);
+  i.WriteHtonU32 (((uint32_t) m_fractionLost << 24) | (m_cumulativeLost & 0xffffff));
+  i.WriteHtonU32 (m_highestSeq);
+  i.WriteHtonU32 (m_jitter);
+  i.WriteHtonU32 (m_lsr);
+  i.WriteHtonU32 (m_dlsr);
+  i.WriteHtonU32 (m_oneWayDelay);
+}
+
+uint32_t
+RtcpReceiverReportHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint8_t byte = i.ReadU8 ();
+  NS_ASSERT_MSG ((byte >> 6) == RTCP_VERSION, "Unexpected RTCP version " << (byte >> 6));
+  byte = i.ReadU8 ();
+  NS_ASSERT_MSG (byte == PT_RR, "Not a receiver report " << (uint32_t) byte);
+  i.ReadNtohU16 ();
+  m_senderSsrc = i.ReadNtohU32 ();
+  m_sourceSsrc = i.ReadNtohU32 ();
+  uint32_t lost = i.ReadNtohU32 ();
+  m_fractionLost = lost >> 24;
+  //24비트 부호 확장
+  m_cumulativeLost = (lost & 0x800000) ? (int32_t) (lost | 0xff000000) : (int32_t) (lost & 0xffffff);
+  m_highestSeq = i.ReadNtohU32 ();
+  m_jitter = i.ReadNtohU32 ();
+  m_lsr = i.ReadNtohU32 ();
+  m_dlsr = i.ReadNtohU32 ();
+  m_oneWayDelay = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+RtcpNackHeader::RtcpNackHeader ()
+  : m_senderSsrc (0),
+    m_mediaSsrc (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtcpNackHeader::SetSenderSsrc (uint32_t ssrc)
+{
+  m_senderSsrc = ssrc;
+}
+
+uint32_t
+RtcpNackHeader::GetSenderSsrc (void) const
+{
+  return m_senderSsrc;
+}
+
+void
+RtcpNackHeader::SetMediaSsrc (uint32_t ssrc)
+{
+  m_mediaSsrc = ssrc;
+}
+
+uint32_t
+RtcpNackHeader::GetMediaSsrc (void) const
+{
+  return m_mediaSsrc;
+}
+
+void
+RtcpNackHeader::AddLostSequence (uint16_t seq)
+{
+  //직전 항목의 PID 뒤 16개 이내면 BLP 비트로 표시
+  if (!m_items.empty ())
+    {
+      uint16_t pid = m_items.back () >> 16;
+      uint16_t offset = seq - pid;
+      if (offset == 0)
+        {
+          return;
+        }
+      if (offset <= 16)
+        {
+          m_items.back () |= 1u << (offset - 1);
+          return;
+        }
+    }
+  m_items.push_back ((uint32_t) seq << 16);
+}
+
+std::vector<uint16_t>
+RtcpNackHeader::GetLostSequences (void) const
+{
+  std::vector<uint16_t> lost;
+  for (uint32_t item : m_items)
+    {
+      uint16_t pid = item >> 16;
+      lost.push_back (pid);
+      for (uint16_t bit = 0; bit < 16; bit++)
+        {
+          if (item & (1u << bit))
+            {
+              lost.push_back (pid + bit + 1);
+            }
+        }
+    }
+  return lost;
+}
+
+uint32_t
+RtcpNackHeader::GetItemCount (void) const
+{
+  return m_items.size ();
+}
+
+TypeId
+RtcpNackHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtcpNackHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtcpNackHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtcpNackHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtcpNackHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(NACK ssrc=" << m_senderSsrc << " media=" << m_mediaSsrc << " lost=";
+  std::vector<uint16_t> lost = GetLostSequences ();
+  for (uint32_t idx = 0; idx < lost.size (); idx++)
+    {
+      os << (idx == 0 ? "" : ",") << lost[idx];
+    }
+  os << ")";
+}
+
+uint32_t
+RtcpNackHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 4 + 4 * m_items.size ();
+}
+
+void
+RtcpNackHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 ((RTCP_VERSION << 6) | FMT_GENERIC_NACK);
+  i.WriteU8 (PT_RTPFB);
+  i.WriteHtonU16 (GetSerializedSize () / 4 - 1);
+  i.WriteHtonU32 (m_senderSsrc);
+  i.WriteHtonU32 (m_mediaSsrc);
+  for (uint32_t item : m_items)
+    {
+      i.WriteHtonU32 (item);
+    }
+}
+
+uint32_t
+RtcpNackHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint8_t byte = i.ReadU8 ();
+  NS_ASSERT_MSG ((byte >> 6) == RTCP_VERSION, "Unexpected RTCP version " << (byte >> 6));
+  byte = i.ReadU8 ();
+  NS_ASSERT_MSG (byte == PT_RTPFB, "Not a transport layer feedback " << (uint32_t) byte);
+  NS_UNUSED (byte);
+  uint16_t length = i.ReadNtohU16 ();
+  m_senderSsrc = i.ReadNtohU32 ();
+  m_mediaSsrc = i.ReadNtohU32 ();
+  m_items.clear ();
+  for (uint32_t idx = 2; idx < length; idx++)
+    {
+      m_items.push_back (i.ReadNtohU32 ());
+    }
+  return GetSerializedSize ();
+}
+
+}
@@ -0,0 +1,159 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTCP 헤더
+
+RFC 3550 6.4.2 Receiver Report (RR), report block 1개
+
+ V=2|P|RC | PT=201 | length
+ SSRC of packet sender
+ SSRC of source
+ fraction lost(8) | cumulative number of packets lost(24)
+ extended highest sequence number received
+ interarrival jitter
+ last SR (LSR)
+ delay since last SR (DLSR)
+ (profile-specific extension) mean one-way delay
+
+서버는 SR을 보내지 않으므로 LSR에는 마지막으로 받은 RTP 패킷의 전송 시각을,
+DLSR에는 그 패킷을 받은 뒤 지난 시간을 기록합니다.
+서버는 (현재 시각 - LSR - DLSR)로 RTT를 계산할 수 있습니다.
+LSR, DLSR 단위는 RFC와 같이 1/65536초, jitter 단위는 RTP 클럭 대신 마이크로초입니다.
+확장 필드에는 보고 구간 동안의 평균 one-way delay(마이크로초)를 기록합니다.
+
+RFC 4585 6.2.1 Generic NACK (RTPFB, FMT=1)
+
+ V=2|P|FMT=1 | PT=205 | length
+ SSRC of packet sender
+ SSRC of media source
+ PID(16) | BLP(16)  (손실 패킷 하나 + 그 뒤 16개 패킷의 손실 비트마스크, 반복)
+
+PID는 RTP 시퀀스의 하위 16비트이며, 서버가 보낸 시퀀스를 기준으로 확장합니다.
+
+수신 측은 RtcpCommonHeader를 PeekHeader해서 패킷 타입을 먼저 확인합니다.
+
+*/
+
+#ifndef RTCP_HEADER_H
+#define RTCP_HEADER_H
+
+#include <ns3/header.h>
+#include <ns3/nstime.h>
+#include <vector>
+
+namespace ns3 {
+
+//모든 RTCP 패킷의 공통 헤더 (V, P, count/FMT, PT, length)
+class RtcpCommonHeader : public Header
+{
+public:
+  RtcpCommonHeader ();
+
+  uint8_t GetCount (void) const;
+  uint8_t GetPacketType (void) const;
+  //공통 헤더를 포함한 RTCP 패킷 전체 길이 (바이트)
+  uint32_t GetPacketSize (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_count;            //RC 또는 FMT
+  uint8_t m_packetType;       //PT
+  uint16_t m_length;          //32비트 워드 수 - 1
+};
+
+class RtcpReceiverReportHeader : public Header
+{
+public:
+  RtcpReceiverReportHeader ();
+
+  void SetSenderSsrc (uint32_t ssrc);
+  uint32_t GetSenderSsrc (void) const;
+  void SetSourceSsrc (uint32_t ssrc);
+  uint32_t GetSourceSsrc (void) const;
+  //0~1 사이의 loss 비율, 1/256 단위로 저장
+  void SetFractionLost (double fractionLost);
+  double GetFractionLost (void) const;
+  void SetCumulativeLost (int32_t lost);
+  int32_t GetCumulativeLost (void) const;
+  void SetHighestSeq (uint32_t seq);
+  uint32_t GetHighestSeq (void) const;
+  //interarrival jitter, 마이크로초 단위로 저장
+  void SetJitter (Time jitter);
+  Time GetJitter (void) const;
+  void SetLastSr (Time lsr);
+  Time GetLastSr (void) const;
+  void SetDelaySinceLastSr (Time dlsr);
+  Time GetDelaySinceLastSr (void) const;
+  //보고 구간의 평균 one-way delay, 마이크로초 단위로 저장
+  void SetOneWayDelay (Time delay);
+  Time GetOneWayDelay (void) const;
+
+  //LSR, DLSR로 계산한 RTT (now는 보고서를 받은 시각)
+  Time GetRoundTripTime (Time now) const;
+
+  //시각을 1/65536초 단위 32비트 값으로 변환
+  static uint32_t TimeToCompact (Time time);
+  static Time CompactToTime (uint32_t compact);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  const static uint8_t PT_RR = 201;
+
+private:
+  uint32_t m_senderSsrc;      //보고서를 보낸 쪽 SSRC
+  uint32_t m_sourceSsrc;      //보고 대상 RTP 스트림 SSRC
+  uint8_t m_fractionLost;     //마지막 보고 이후 loss 비율 (1/256 단위)
+  int32_t m_cumulativeLost;   //누적 loss 패킷 수 (24비트)
+  uint32_t m_highestSeq;      //수신한 가장 큰 시퀀스
+  uint32_t m_jitter;          //interarrival jitter (us)
+  uint32_t m_lsr;             //LSR (1/65536초)
+  uint32_t m_dlsr;            //DLSR (1/65536초)
+  uint32_t m_oneWayDelay;     //평균 one-way delay (us)
+};
+
+class RtcpNackHeader : public Header
+{
+public:
+  RtcpNackHeader ();
+
+  void SetSenderSsrc (uint32_t ssrc);
+  uint32_t GetSenderSsrc (void) const;
+  void SetMediaSsrc (uint32_t ssrc);
+  uint32_t GetMediaSsrc (void) const;
+  //손실 시퀀스 추가, 오름차순으로 추가해야 BLP로 묶임
+  void AddLostSequence (uint16_t seq);
+  std::vector<uint16_t> GetLostSequences (void) const;
+  //PID/BLP 항목 개수
+  uint32_t GetItemCount (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  const static uint8_t PT_RTPFB = 205;
+  const static uint8_t FMT_GENERIC_NACK = 1;
+
+private:
+  uint32_t m_senderSsrc;      //NACK을 보낸 쪽 SSRC
+  uint32_t m_mediaSsrc;       //손실이 일어난 RTP 스트림 SSRC
+  std::vector<uint32_t> m_items; //PID(16) | BLP(16)
+};
+
+}
+
+#endif
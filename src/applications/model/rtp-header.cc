@@ -0,0 +1,312 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtp-header.h"
+
+#include <ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE("RtpHeader");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RtpHeader);
+NS_OBJECT_ENSURE_REGISTERED(RtpFecHeader);
+
+static const uint8_t RTP_VERSION = 2;
+
+RtpHeader::RtpHeader ()
+  : m_marker (false),
+    m_payloadType (96),
+    m_frameId (0),
+    m_fragmentIndex (0),
+    m_fragmentCount (1),
+    m_representation (0),
+    m_frameType (0),
+    m_referenceDistance (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtpHeader::SetMarker (bool marker)
+{
+  m_marker = marker;
+}
+
+bool
+RtpHeader::GetMarker (void) const
+{
+  return m_marker;
+}
+
+void
+RtpHeader::SetPayloadType (uint8_t payloadType)
+{
+  NS_ASSERT (payloadType < 128);
+  m_payloadType = payloadType;
+}
+
+uint8_t
+RtpHeader::GetPayloadType (void) const
+{
+  return m_payloadType;
+}
+
+void
+RtpHeader::SetFrameId (uint32_t frameId)
+{
+  m_frameId = frameId;
+}
+
+uint32_t
+RtpHeader::GetFrameId (void) const
+{
+  return m_frameId;
+}
+
+void
+RtpHeader::SetFragmentIndex (uint16_t index)
+{
+  m_fragmentIndex = index;
+}
+
+uint16_t
+RtpHeader::GetFragmentIndex (void) const
+{
+  return m_fragmentIndex;
+}
+
+void
+RtpHeader::SetFragmentCount (uint16_t count)
+{
+  m_fragmentCount = count;
+}
+
+uint16_t
+RtpHeader::GetFragmentCount (void) const
+{
+  return m_fragmentCount;
+}
+
+void
+RtpHeader::SetRepresentation (uint8_t representation)
+{
+  m_representation = representation;
+}
+
+uint8_t
+RtpHeader::GetRepresentation (void) const
+{
+  return m_representation;
+}
+
+void
+RtpHeader::SetFrameType (uint8_t frameType)
+{
+  m_frameType = frameType;
+}
+
+uint8_t
+RtpHeader::GetFrameType (void) const
+{
+  return m_frameType;
+}
+
+void
+RtpHeader::SetReferenceDistance (uint16_t distance)
+{
+  m_referenceDistance = distance;
+}
+
+uint16_t
+RtpHeader::GetReferenceDistance (void) const
+{
+  return m_referenceDistance;
+}
+
+TypeId
+RtpHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtpHeader")
+    .SetParent<SeqTsHeader> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtpHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtpHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtpHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  SeqTsHeader::Print (os);
+  os << "(frame=" << m_frameId << " fragment=" << m_fragmentIndex << "/" << m_fragmentCount
+     << " marker=" << m_marker << " pt=" << (uint32_t) m_payloadType
+     << " representation=" << (uint32_t) m_representation
+     << " type=" << "IPB"[m_frameType % 3] << " ref=-" << m_referenceDistance << ")";
+}
+
+//V(2) P X CC | M PT | SeqTsHeader | frameId | fragmentIndex | fragmentCount | representation
+//| frameType | referenceDistance
+uint32_t
+RtpHeader::GetSerializedSize (void) const
+{
+  return 2 + SeqTsHeader::GetSerializedSize () + 4 + 2 + 2 + 1 + 1 + 2;
+}
+
+void
+RtpHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (RTP_VERSION << 6);
+  i.WriteU8 ((m_marker ? 0x80 : 0) | m_payloadType);
+  SeqTsHeader::Serialize (i);
+  i.Next (SeqTsHeader::GetSerializedSize ());
+  i.WriteHtonU32 (m_frameId);
+  i.WriteHtonU16 (m_fragmentIndex);
+  i.WriteHtonU16 (m_fragmentCount);
+  i.WriteU8 (m_representation);
+  i.WriteU8 (m_frameType);
+  i.WriteHtonU16 (m_referenceDistance);
+}
+
+uint32_t
+RtpHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint8_t byte = i.ReadU8 ();
+  NS_ASSERT_MSG ((byte >> 6) == RTP_VERSION, "Unexpected RTP version " << (byte >> 6));
+  byte = i.ReadU8 ();
+  m_marker = (byte & 0x80) != 0;
+  m_payloadType = byte & 0x7f;
+  i.Next (SeqTsHeader::Deserialize (i));
+  m_frameId = i.ReadNtohU32 ();
+  m_fragmentIndex = i.ReadNtohU16 ();
+  m_fragmentCount = i.ReadNtohU16 ();
+  m_representation = i.ReadU8 ();
+  m_frameType = i.ReadU8 ();
+  m_referenceDistance = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+RtpFecHeader::RtpFecHeader ()
+  : m_baseSeq (0),
+    m_count (0),
+    m_lengthRecovery (0),
+    m_headerRecovery (RtpHeader ().GetSerializedSize (), 0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtpFecHeader::SetBaseSeq (uint32_t seq)
+{
+  m_baseSeq = seq;
+}
+
+uint32_t
+RtpFecHeader::GetBaseSeq (void) const
+{
+  return m_baseSeq;
+}
+
+void
+RtpFecHeader::SetCount (uint8_t count)
+{
+  m_count = count;
+}
+
+uint8_t
+RtpFecHeader::GetCount (void) const
+{
+  return m_count;
+}
+
+void
+RtpFecHeader::SetLengthRecovery (uint16_t length)
+{
+  m_lengthRecovery = length;
+}
+
+uint16_t
+RtpFecHeader::GetLengthRecovery (void) const
+{
+  return m_lengthRecovery;
+}
+
+void
+RtpFecHeader::SetHeaderRecovery (const std::vector<uint8_t> &header)
+{
+  NS_ASSERT (header.size () == m_headerRecovery.size ());
+  m_headerRecovery = header;
+}
+
+const std::vector<uint8_t> &
+RtpFecHeader::GetHeaderRecovery (void) const
+{
+  return m_headerRecovery;
+}
+
+TypeId
+RtpFecHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtpFecHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtpFecHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtpFecHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtpFecHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(FEC base=" << m_baseSeq << " count=" << (uint32_t) m_count
+     << " length=" << m_lengthRecovery << ")";
+}
+
+uint32_t
+RtpFecHeader::GetSerializedSize (void) const
+{
+  return 4 + 1 + 1 + 2 + m_headerRecovery.size ();
+}
+
+void
+RtpFecHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_baseSeq);
+  i.WriteU8 (m_count);
+  i.WriteU8 (0);
+  i.WriteHtonU16 (m_lengthRecovery);
+  i.Write (m_headerRecovery.data (), m_headerRecovery.size ());
+}
+
+uint32_t
+RtpFecHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_baseSeq = i.ReadNtohU32 ();
+  m_count = i.ReadU8 ();
+  i.ReadU8 ();
+  m_lengthRecovery = i.ReadNtohU16 ();
+  i.Read (m_headerRecovery.data (), m_headerRecovery.size ());
+  return GetSerializedSize ();
+}
+
+}
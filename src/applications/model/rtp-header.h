@@ -0,0 +1,108 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP 헤더
+
+SeqTsHeader(시퀀스, 전송 시각)에 프레임 분할 정보를 추가한 헤더
+하나의 프레임은 MTU 크기에 맞게 여러 RTP 패킷으로 나누어 전송되며
+각 패킷은 프레임 번호, 조각 번호, 조각 개수를 가집니다.
+프레임의 마지막 조각에는 marker 비트가 설정됩니다.
+representation은 프레임을 어느 비트레이트 트레이스에서 가져왔는지 나타냅니다.
+프레임 타입(I/P/B)과 참조 거리(프레임 번호 - 참조 앵커 프레임 번호, 참조가 없으면 0)로
+수신 측에서 디코딩 가능 여부를 판단합니다.
+
+FEC 패킷 (XOR 패리티, RFC 5109와 같은 방식)
+연속된 RTP 패킷 묶음(baseSeq부터 count개)의 직렬화된 RtpHeader 바이트와
+페이로드 길이를 XOR해서 보냅니다. 묶음에서 패킷 하나가 손실되면
+나머지 패킷과 XOR해서 손실된 패킷의 헤더와 길이를 복원합니다.
+FEC 패킷은 payload type이 RtpFecHeader::PAYLOAD_TYPE인 RtpHeader 뒤에 붙으며,
+시퀀스는 미디어 패킷과 별도로 매깁니다.
+
+ baseSeq(4) | count(1) | reserved(1) | length recovery(2) | header recovery(RtpHeader 크기)
+
+*/
+
+#ifndef RTP_HEADER_H
+#define RTP_HEADER_H
+
+#include "seq-ts-header.h"
+#include <vector>
+
+namespace ns3 {
+
+class RtpHeader : public SeqTsHeader
+{
+public:
+  RtpHeader ();
+
+  void SetMarker (bool marker);
+  bool GetMarker (void) const;
+  void SetPayloadType (uint8_t payloadType);
+  uint8_t GetPayloadType (void) const;
+  void SetFrameId (uint32_t frameId);
+  uint32_t GetFrameId (void) const;
+  void SetFragmentIndex (uint16_t index);
+  uint16_t GetFragmentIndex (void) const;
+  void SetFragmentCount (uint16_t count);
+  uint16_t GetFragmentCount (void) const;
+  void SetRepresentation (uint8_t representation);
+  uint8_t GetRepresentation (void) const;
+  //RtspFrameTrace::FrameType_t
+  void SetFrameType (uint8_t frameType);
+  uint8_t GetFrameType (void) const;
+  void SetReferenceDistance (uint16_t distance);
+  uint16_t GetReferenceDistance (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  bool m_marker;              //프레임의 마지막 조각 여부
+  uint8_t m_payloadType;      //페이로드 타입
+  uint32_t m_frameId;         //프레임 번호
+  uint16_t m_fragmentIndex;   //프레임 내 조각 번호
+  uint16_t m_fragmentCount;   //프레임의 전체 조각 개수
+  uint8_t m_representation;   //프레임의 representation 번호 (0이 가장 낮은 비트레이트)
+  uint8_t m_frameType;        //프레임 타입 (I/P/B)
+  uint16_t m_referenceDistance; //참조 앵커 프레임까지의 거리, 참조가 없으면 0
+};
+
+class RtpFecHeader : public Header
+{
+public:
+  RtpFecHeader ();
+
+  void SetBaseSeq (uint32_t seq);
+  uint32_t GetBaseSeq (void) const;
+  void SetCount (uint8_t count);
+  uint8_t GetCount (void) const;
+  void SetLengthRecovery (uint16_t length);
+  uint16_t GetLengthRecovery (void) const;
+  //직렬화된 RtpHeader 바이트의 XOR, 길이는 RtpHeader 크기와 같아야 함
+  void SetHeaderRecovery (const std::vector<uint8_t> &header);
+  const std::vector<uint8_t> &GetHeaderRecovery (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  const static uint8_t PAYLOAD_TYPE = 127;
+
+private:
+  uint32_t m_baseSeq;         //보호하는 첫 RTP 시퀀스
+  uint8_t m_count;            //보호하는 RTP 패킷 수
+  uint16_t m_lengthRecovery;  //페이로드 길이의 XOR
+  std::vector<uint8_t> m_headerRecovery; //RtpHeader 바이트의 XOR
+};
+
+}
+
+#endif
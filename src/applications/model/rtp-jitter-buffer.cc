@@ -0,0 +1,173 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtp-jitter-buffer.h"
+
+#include <algorithm>
+#include <ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE("RtpJitterBuffer");
+
+namespace ns3 {
+
+bool
+RtpJitterBuffer::Entry::IsComplete (void) const
+{
+  return fragments >= fragmentCount;
+}
+
+RtpJitterBuffer::RtpJitterBuffer (uint32_t capacity)
+{
+  SetCapacity (capacity);
+}
+
+void
+RtpJitterBuffer::SetCapacity (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ASSERT (capacity > 0);
+  std::vector<Entry> (capacity, Entry ()).swap (m_slots);
+  m_head = 0;
+  m_end = 0;
+  m_evicted = 0;
+  Clear ();
+}
+
+uint32_t
+RtpJitterBuffer::GetCapacity (void) const
+{
+  return m_slots.size ();
+}
+
+RtpJitterBuffer::Entry *
+RtpJitterBuffer::Insert (uint32_t frameId, uint16_t fragmentCount, uint32_t bytes, Time arrival)
+{
+  if (frameId < m_head)
+    {
+      return 0;
+    }
+
+  //범위를 넘으면 오래된 프레임부터 밀어냄
+  const uint32_t capacity = m_slots.size ();
+  if (frameId - m_head >= capacity)
+    {
+      uint32_t count = m_count;
+      DiscardBefore (frameId - capacity + 1);
+      m_evicted += count - m_count;
+      NS_LOG_LOGIC ("Evicted " << count - m_count << " frames for frame " << frameId);
+    }
+
+  Entry &entry = m_slots[frameId % capacity];
+  if (!entry.valid)
+    {
+      entry.valid = true;
+      entry.frameId = frameId;
+      entry.size = 0;
+      entry.fragments = 0;
+      entry.fragmentCount = fragmentCount;
+      entry.arrival = arrival;
+      entry.frameType = 0;
+      entry.reference = frameId;
+      entry.representation = 0;
+      m_count++;
+    }
+  NS_ASSERT (entry.frameId == frameId);
+  entry.size += bytes;
+  entry.fragments++;
+  m_end = std::max (m_end, frameId + 1);
+  return &entry;
+}
+
+RtpJitterBuffer::Entry *
+RtpJitterBuffer::Find (uint32_t frameId)
+{
+  if (frameId < m_head || frameId >= m_end)
+    {
+      return 0;
+    }
+  Entry &entry = m_slots[frameId % m_slots.size ()];
+  return (entry.valid && entry.frameId == frameId) ? &entry : 0;
+}
+
+RtpJitterBuffer::Entry *
+RtpJitterBuffer::FindNext (uint32_t frameId)
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  for (uint32_t id = std::max (frameId, m_head); id < m_end; id++)
+    {
+      Entry &entry = m_slots[id % m_slots.size ()];
+      if (entry.valid && entry.frameId == id)
+        {
+          return &entry;
+        }
+    }
+  return 0;
+}
+
+void
+RtpJitterBuffer::DiscardBefore (uint32_t frameId)
+{
+  if (frameId <= m_head)
+    {
+      return;
+    }
+
+  //버려지는 구간의 슬롯만 비움 (최대 capacity 개)
+  const uint32_t capacity = m_slots.size ();
+  uint32_t last = std::min (frameId, m_end);
+  if (last > m_head && last - m_head > capacity)
+    {
+      Clear ();
+    }
+  else
+    {
+      for (uint32_t id = m_head; id < last; id++)
+        {
+          Entry &entry = m_slots[id % capacity];
+          if (entry.valid && entry.frameId == id)
+            {
+              entry.valid = false;
+              m_count--;
+            }
+        }
+    }
+  m_head = frameId;
+  m_end = std::max (m_end, m_head);
+}
+
+uint32_t
+RtpJitterBuffer::GetSize (void) const
+{
+  return m_count;
+}
+
+uint32_t
+RtpJitterBuffer::GetHead (void) const
+{
+  return m_head;
+}
+
+uint32_t
+RtpJitterBuffer::GetEvicted (void) const
+{
+  return m_evicted;
+}
+
+uint64_t
+RtpJitterBuffer::GetFootprint (void) const
+{
+  return m_slots.capacity () * sizeof (Entry);
+}
+
+void
+RtpJitterBuffer::Clear (void)
+{
+  for (auto &entry : m_slots)
+    {
+      entry.valid = false;
+    }
+  m_count = 0;
+}
+
+}
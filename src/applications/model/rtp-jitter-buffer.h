@@ -0,0 +1,74 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP 지터 버퍼
+
+프레임 번호로 인덱싱되는 고정 크기 링 버퍼
+페이로드는 저장하지 않고 프레임의 메타데이터(크기, 도착 시각, 조각 수)만 저장합니다.
+
+- 슬롯 위치: frameId % capacity
+- [head, head + capacity) 범위의 프레임만 보관
+- 범위를 넘는 프레임이 들어오면 가장 오래된 프레임부터 밀려남
+
+*/
+
+#ifndef RTP_JITTER_BUFFER_H
+#define RTP_JITTER_BUFFER_H
+
+#include <ns3/nstime.h>
+#include <vector>
+
+namespace ns3 {
+
+class RtpJitterBuffer
+{
+public:
+  struct Entry
+  {
+    uint32_t frameId;           //프레임 번호
+    uint32_t size;              //수신한 페이로드 바이트
+    uint16_t fragments;         //수신한 조각 개수
+    uint16_t fragmentCount;     //프레임의 전체 조각 개수
+    Time arrival;               //첫 조각 도착 시각
+    uint8_t frameType;          //프레임 타입 (RtspFrameTrace::FrameType_t)
+    uint32_t reference;         //참조 앵커 프레임 번호, 참조가 없으면 frameId
+    uint8_t representation;     //프레임을 보낸 representation 번호
+    bool valid;                 //슬롯 사용 여부
+
+    bool IsComplete (void) const;
+  };
+
+  RtpJitterBuffer (uint32_t capacity = 256);
+
+  //용량을 바꾸면 버퍼는 비워짐
+  void SetCapacity (uint32_t capacity);
+  uint32_t GetCapacity (void) const;
+
+  //조각 하나를 프레임에 추가, 이미 버려진 프레임이면 0 반환
+  Entry *Insert (uint32_t frameId, uint16_t fragmentCount, uint32_t bytes, Time arrival);
+  //frameId 프레임 탐색, 없으면 0 반환
+  Entry *Find (uint32_t frameId);
+  //frameId 이후에 처음으로 존재하는 프레임 탐색, 없으면 0 반환
+  Entry *FindNext (uint32_t frameId);
+  //frameId 미만의 모든 프레임 버림
+  void DiscardBefore (uint32_t frameId);
+
+  uint32_t GetSize (void) const;
+  uint32_t GetHead (void) const;
+  uint32_t GetEvicted (void) const;
+  //슬롯 배열이 차지하는 바이트
+  uint64_t GetFootprint (void) const;
+  void Clear (void);
+
+private:
+  std::vector<Entry> m_slots;   //링 버퍼
+  uint32_t m_head;              //보관 중인 가장 작은 프레임 번호 (그 이전은 모두 버려짐)
+  uint32_t m_end;               //수신한 가장 큰 프레임 번호 + 1
+  uint32_t m_count;             //보관 중인 프레임 수
+  uint32_t m_evicted;           //재생 전에 밀려난 프레임 수
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtp-packet-pool.h"
+
+#include <ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE("RtpPacketPool");
+
+namespace ns3 {
+
+RtpPacketPool::RtpPacketPool (uint32_t capacity)
+{
+  SetCapacity (capacity);
+}
+
+void
+RtpPacketPool::SetCapacity (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  m_slots.assign (capacity, Slot ());
+  m_clock = 0;
+  m_hits = 0;
+  m_misses = 0;
+  Clear ();
+}
+
+uint32_t
+RtpPacketPool::GetCapacity (void) const
+{
+  return m_slots.size ();
+}
+
+Ptr<Packet>
+RtpPacketPool::Create (uint32_t payloadSize)
+{
+  if (m_slots.empty ())
+    {
+      return ns3::Create<Packet> (payloadSize);
+    }
+
+  m_clock++;
+  Slot *victim = &m_slots[0];
+  for (auto &slot : m_slots)
+    {
+      if (slot.packet != 0 && slot.size == payloadSize)
+        {
+          slot.lastUse = m_clock;
+          m_hits++;
+          return slot.packet->Copy ();
+        }
+      if (slot.packet == 0 || (victim->packet != 0 && slot.lastUse < victim->lastUse))
+        {
+          victim = &slot;
+        }
+    }
+
+  //없는 크기면 비어 있거나 가장 오래 사용되지 않은 슬롯에 새 템플릿 생성
+  NS_LOG_LOGIC ("New template of " << payloadSize << " bytes");
+  m_misses++;
+  victim->size = payloadSize;
+  victim->packet = ns3::Create<Packet> (payloadSize);
+  victim->lastUse = m_clock;
+  return victim->packet->Copy ();
+}
+
+uint64_t
+RtpPacketPool::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+RtpPacketPool::GetMisses (void) const
+{
+  return m_misses;
+}
+
+void
+RtpPacketPool::Clear (void)
+{
+  for (auto &slot : m_slots)
+    {
+      slot.size = 0;
+      slot.packet = 0;
+      slot.lastUse = 0;
+    }
+}
+
+}
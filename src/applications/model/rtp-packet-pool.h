@@ -0,0 +1,65 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP 패킷 풀
+
+서버 송신 경로에서 RTP/FEC 페이로드 패킷을 만들 때 사용합니다.
+페이로드 크기 별로 0으로 채워진 템플릿 패킷을 하나씩 보관하고, 요청마다 템플릿의 Copy()를 반환합니다.
+Copy()는 버퍼를 복사하지 않고 공유하므로 (copy-on-write) 같은 크기의 패킷을 반복해서 만들 때
+Create<Packet>(size)의 버퍼/메타데이터 초기화를 건너뜁니다.
+
+- MTU로 나눈 조각은 마지막 조각을 빼면 모두 같은 크기라서 적은 수의 슬롯으로 대부분 재사용됨
+- 슬롯이 모두 차면 가장 오래 사용되지 않은 크기를 교체 (LRU)
+- 용량이 0이면 풀을 사용하지 않고 매번 새로 생성 (RtspServer 기본값)
+
+주의: Packet::Copy()는 패킷 UID와 메타데이터를 그대로 가져오므로
+같은 템플릿에서 나온 패킷(같은 페이로드 크기)은 모두 같은 GetUid()를 가집니다.
+pcap/ascii 트레이스나 UID로 패킷을 구분하는 트레이스 소비자를 사용할 때는 풀을 끄십시오.
+Create<Packet>(size)도 페이로드를 가상의 0 영역으로만 잡으므로 절약되는 것은 버퍼 초기화 정도이며,
+RtspBenchmark의 --packetPoolSize로 효과를 측정한 뒤 켜는 것을 권장합니다.
+
+*/
+
+#ifndef RTP_PACKET_POOL_H
+#define RTP_PACKET_POOL_H
+
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <vector>
+
+namespace ns3 {
+
+class RtpPacketPool
+{
+public:
+  RtpPacketPool (uint32_t capacity = 0);
+
+  //용량을 바꾸면 풀은 비워짐
+  void SetCapacity (uint32_t capacity);
+  uint32_t GetCapacity (void) const;
+
+  //0으로 채워진 payloadSize 바이트 페이로드 패킷 반환, 반환된 패킷은 호출자가 자유롭게 수정 가능
+  Ptr<Packet> Create (uint32_t payloadSize);
+
+  uint64_t GetHits (void) const;
+  uint64_t GetMisses (void) const;
+  void Clear (void);
+
+private:
+  struct Slot
+  {
+    uint32_t size;              //페이로드 크기
+    Ptr<Packet> packet;         //템플릿 패킷, 비어 있으면 0
+    uint64_t lastUse;           //마지막으로 사용된 시점 (m_clock)
+  };
+
+  std::vector<Slot> m_slots;    //크기 별 템플릿
+  uint64_t m_clock;             //Create 호출 횟수 (LRU 기준)
+  uint64_t m_hits;              //템플릿을 재사용한 횟수
+  uint64_t m_misses;            //새 템플릿을 만든 횟수
+};
+
+}
+
+#endif
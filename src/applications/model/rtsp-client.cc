@@ -1,9 +1,9 @@
 /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
 
 #include "rtsp-client.h"
-#include "seq-ts-header.h"
+#include "rtp-header.h"
+#include "rtcp-header.h"
 
-#include <sstream>
 #include <ns3/log.h>
 #include <ns3/simulator.h>
 #include <ns3/callback.h>
@@ -19,6 +19,11 @@
 #include <ns3/inet6-socket-address.h>
 #include <ns3/unused.h>
 #include <ns3/string.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/enum.h>
+#include <ns3/node.h>
+#include <iostream>
 
 NS_LOG_COMPONENT_DEFINE("RtspClient");
 
@@ -61,14 +66,118 @@ RtspClient::GetTypeId (void)
                     MakeUintegerAccessor (&RtspClient::m_rtpPort),
                     MakeUintegerChecker<uint16_t> ())
         .AddAttribute ("FileName",
-                   "Name of file.",
+                   "Name of file. Several trace files separated by commas "
+                   "are streamed as a bitrate ladder. The whole value is sent as the "
+                   "SETUP url and may be at most 256 bytes.",
                    StringValue ("sample.txt"),
                    MakeStringAccessor (&RtspClient::m_fileName),
                    MakeStringChecker ())
+        .AddAttribute ("JitterBufferCapacity",
+                   "Number of frames the jitter buffer can hold ahead of playout.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&RtspClient::m_jitterBufferCapacity),
+                   MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("MemoryLimit",
+                   "Bytes this client may hold in its jitter buffer ring, FEC window, NACK list and "
+                   "control buffers (0 means no limit). The jitter buffer capacity is reduced at start "
+                   "to fit; the NACK list is trimmed at run time.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RtspClient::m_memoryLimit),
+                   MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("MemoryLimitPolicy",
+                   "What is done with a lost sequence that would grow the NACK list over MemoryLimit.",
+                   EnumValue (RtspClient::EVICT_OLDEST),
+                   MakeEnumAccessor (&RtspClient::m_memoryLimitPolicy),
+                   MakeEnumChecker (RtspClient::EVICT_OLDEST, "EvictOldest",
+                                    RtspClient::DROP_NEWEST, "DropNewest"))
+        .AddAttribute ("Multicast",
+                   "Request multicast delivery in SETUP; the client receives RTP on the "
+                   "group and port returned by the server if it supports multicast.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RtspClient::m_multicast),
+                   MakeBooleanChecker ())
+        .AddAttribute ("EnableNack",
+                   "Send RTCP NACKs for missing RTP packets so the server can retransmit them. "
+                   "NACK support is announced in SETUP so the server keeps sent packets from the start.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RtspClient::m_enableNack),
+                   MakeBooleanChecker ())
+        .AddAttribute ("MaxNackRetries",
+                   "Maximum number of NACKs sent for one missing RTP packet.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RtspClient::m_maxNackRetries),
+                   MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("AdaptivePlayout",
+                   "Start playback, and resume it after a stall, only once the buffered "
+                   "media reaches the playout target instead of a fixed two frame delay.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RtspClient::m_adaptivePlayout),
+                   MakeBooleanChecker ())
+        .AddAttribute ("PlayoutBufferTarget",
+                   "Buffer depth required to start adaptive playout when no jitter is measured.",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&RtspClient::m_playoutBase),
+                   MakeTimeChecker ())
+        .AddAttribute ("MinPlayoutBufferTarget",
+                   "Lower bound of the adaptive playout target.",
+                   TimeValue (MilliSeconds (40)),
+                   MakeTimeAccessor (&RtspClient::m_minPlayoutTarget),
+                   MakeTimeChecker ())
+        .AddAttribute ("MaxPlayoutBufferTarget",
+                   "Upper bound of the adaptive playout target.",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&RtspClient::m_maxPlayoutTarget),
+                   MakeTimeChecker ())
+        .AddAttribute ("PlayoutJitterFactor",
+                   "Multiple of the measured interarrival jitter added to the playout target.",
+                   DoubleValue (4.0),
+                   MakeDoubleAccessor (&RtspClient::m_playoutJitterFactor),
+                   MakeDoubleChecker<double> (0))
+        .AddAttribute ("StatsCollector",
+                   "Collector that samples the counters of this client.",
+                   PointerValue (),
+                   MakePointerAccessor (&RtspClient::m_statsCollector),
+                   MakePointerChecker<RtspStatsCollector> ())
+        .AddAttribute ("TickDriver",
+                   "Shared driver that runs the playout and RTCP timers of every client in one event "
+                   "per period. Without it every client schedules its own timer events.",
+                   PointerValue (),
+                   MakePointerAccessor (&RtspClient::m_tickDriver),
+                   MakePointerChecker<RtspTickDriver> ())
+        .AddAttribute ("PrintQoe",
+                   "Print the QoE summary (startup delay, stalls, rebuffering ratio, "
+                   "average bitrate and quality switches) when the application stops.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RtspClient::m_printQoe),
+                   MakeBooleanChecker ())
         .AddTraceSource ("FractionLoss",
                     "Rtsp Fraction Loss",
                     MakeTraceSourceAccessor (&RtspClient::m_fractionLossTrace),
                     "ns3::RtspClient::TracedCallback")
+        .AddTraceSource ("Jitter",
+                    "RTP interarrival jitter, updated on every received packet",
+                    MakeTraceSourceAccessor (&RtspClient::m_jitterTrace),
+                    "ns3::Time::TracedCallback")
+        .AddTraceSource ("OneWayDelay",
+                    "One-way delay of every received RTP packet",
+                    MakeTraceSourceAccessor (&RtspClient::m_oneWayDelayTrace),
+                    "ns3::Time::TracedCallback")
+        .AddTraceSource ("Representation",
+                    "Representation index of the received stream, fired when it changes",
+                    MakeTraceSourceAccessor (&RtspClient::m_representationTrace),
+                    "ns3::RtspClient::RepresentationTracedCallback")
+        .AddTraceSource ("StartupDelay",
+                    "Delay from the first PLAY request to the first played frame",
+                    MakeTraceSourceAccessor (&RtspClient::m_startupDelayTrace),
+                    "ns3::Time::TracedCallback")
+        .AddTraceSource ("Stall",
+                    "Duration of a playout stall, fired when playback resumes or stops",
+                    MakeTraceSourceAccessor (&RtspClient::m_stallTrace),
+                    "ns3::Time::TracedCallback")
+        .AddTraceSource ("QualitySwitch",
+                    "Representation change between two consecutively played frames",
+                    MakeTraceSourceAccessor (&RtspClient::m_qualitySwitchTrace),
+                    "ns3::RtspClient::QualitySwitchTracedCallback")
     ;
     return tid;
 }
@@ -81,18 +190,61 @@ RtspClient::RtspClient ()
     m_rtpPort = 11;
 
     m_state = INIT;
+    m_cseq = 1;
+    m_sessionId = 0;
+    m_rtspRxBuffer = Create<Packet> ();
     m_framePeriod = 10000;
 
     m_frame = 0;
     m_frameCnt = 0;
+    m_frameCount = 0;
+    m_lastFrameReceived = false;
     m_cumLost = 0;
     
-    m_lastSeq = 0;
-    m_lastLost = 0; 
     m_lastFractionLost = 0;
     m_curFractionLost = 0;
 
+    m_baseSeq = 0;
+    m_maxSeq = 0;
+    m_received = 0;
+    m_expectedPrior = 0;
+    m_receivedPrior = 0;
+    m_delayCount = 0;
+
+    m_jitterBufferCapacity = 256;
+
     m_rxSize = 0;
+    m_goodputSize = 0;
+    m_partialFrames = 0;
+    m_decodedFrames = 0;
+    m_undecodableFrames = 0;
+    m_lastDecodedAnchor = 0;
+    m_hasDecodedAnchor = false;
+    m_representation = 0;
+    m_printQoe = false;
+    m_statsSlot = 0;
+    m_memoryLimit = 0;
+    m_memoryLimitPolicy = EVICT_OLDEST;
+    m_memoryEvictedBytes = 0;
+    m_consumeTick = RtspTickDriver::INVALID;
+    m_rtcpTick = RtspTickDriver::INVALID;
+
+    m_adaptivePlayout = false;
+    m_buffering = false;
+    m_playoutBase = MilliSeconds(200);
+    m_minPlayoutTarget = MilliSeconds(40);
+    m_maxPlayoutTarget = Seconds(2);
+    m_playoutJitterFactor = 4.0;
+    m_playoutTarget = m_playoutBase;
+
+    m_multicast = false;
+    m_multicastGroup = Ipv4Address::GetAny ();
+
+    m_enableNack = false;
+    m_maxNackRetries = 2;
+    m_recoveredPackets = 0;
+    m_fecRecoveredPackets = 0;
+    m_fecWindow.resize(FEC_WINDOW);
 }
 
 RtspClient::~RtspClient ()
@@ -109,6 +261,8 @@ RtspClient::DoDispose ()
     {
       StopApplication ();
     }
+  m_statsCollector = 0;
+  m_tickDriver = 0;
 
   Application::DoDispose (); // Chain up.
 }
@@ -118,6 +272,26 @@ RtspClient::StartApplication ()
 {
     NS_LOG_FUNCTION (this);
 
+    //고정 크기 구조(클라이언트, FEC 윈도우 최대 크기)를 빼고 남은 상한에 맞게 지터 버퍼 용량 결정
+    uint32_t capacity = m_jitterBufferCapacity;
+    if(m_memoryLimit > 0)
+    {
+      uint64_t fixed = sizeof(RtspClient) + FEC_WINDOW * sizeof(FecEntry);
+      uint64_t budget = m_memoryLimit > fixed ? (m_memoryLimit - fixed) / sizeof(RtpJitterBuffer::Entry) : 0;
+      if(budget < capacity)
+      {
+        capacity = std::max<uint64_t>(1, budget);
+        NS_LOG_WARN("Jitter buffer capacity reduced from " << m_jitterBufferCapacity << " to "
+                    << capacity << " frames to fit MemoryLimit " << m_memoryLimit);
+      }
+    }
+    m_jitterBuffer.SetCapacity(capacity);
+
+    if (m_statsCollector != 0)
+    {
+        m_statsSlot = m_statsCollector->Register(RtspStatsCollector::CLIENT, GetNode()->GetId(), m_sessionId);
+    }
+
     /*RTSP 소켓 초기화*/
     if (m_rtspSocket == 0)
     {
@@ -141,18 +315,10 @@ RtspClient::StartApplication ()
     /* RTP 소켓 초기화 */
     if (m_rtpSocket == 0)
     {
-        TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-        m_rtpSocket = Socket::CreateSocket (GetNode (), tid);
-
         const Ipv4Address ipv4 = Ipv4Address::ConvertFrom (m_localAddress);
-        const InetSocketAddress inetSocket = InetSocketAddress (ipv4, m_rtpPort);
-        if (m_rtpSocket->Bind (inetSocket) == -1)
-        {
-            NS_FATAL_ERROR ("Failed to bind socket");
-        }
+        BindRtpSocket (InetSocketAddress (ipv4, m_rtpPort));
     }
     NS_ASSERT_MSG (m_rtpSocket != 0, "Failed creating RTP socket.");
-    m_rtpSocket->SetRecvCallback (MakeCallback (&RtspClient::HandleRtpReceive, this));
 
     /* RTCP 소켓 초기화 */
     if (m_rtcpSocket == 0)
@@ -195,6 +361,22 @@ RtspClient::StopApplication ()
   }
   m_consumeEvent.Cancel();
   m_rtcpSendEvent.Cancel();
+  RemoveTick(m_consumeTick);
+  RemoveTick(m_rtcpTick);
+
+  Time stall = m_qoe.NotifyStop(Simulator::Now());
+  if(stall.IsStrictlyPositive())
+  {
+    m_stallTrace(stall);
+  }
+  if(m_printQoe)
+  {
+    std::cout << "RtspClient " << GetNode()->GetId() << " QoE: " << m_qoe << std::endl;
+  }
+  if(m_statsCollector != 0)
+  {
+    m_statsCollector->Unregister(m_statsSlot);
+  }
 
   // Stop listening.
   if (m_rtspSocket != 0)
@@ -227,16 +409,185 @@ RtspClient::GetRxSize()
   return m_rxSize;
 }
 
+uint64_t
+RtspClient::GetGoodputSize()
+{
+  return m_goodputSize;
+}
+
+uint32_t
+RtspClient::GetPartialFrames()
+{
+  return m_partialFrames;
+}
+
+uint32_t
+RtspClient::GetDecodedFrames()
+{
+  return m_decodedFrames;
+}
+
+uint32_t
+RtspClient::GetUndecodableFrames()
+{
+  return m_undecodableFrames;
+}
+
+uint32_t
+RtspClient::GetRecoveredPackets()
+{
+  return m_recoveredPackets;
+}
+
+uint32_t
+RtspClient::GetFecRecoveredPackets()
+{
+  return m_fecRecoveredPackets;
+}
+
 double
 RtspClient::GetFractionLost()
 {
   return m_curFractionLost;
 }
 
+Time
+RtspClient::GetJitter()
+{
+  return m_jitter;
+}
+
+Time
+RtspClient::GetOneWayDelay()
+{
+  return m_oneWayDelay;
+}
+
+const RtspQoeMetrics &
+RtspClient::GetQoeMetrics()
+{
+  return m_qoe;
+}
+
+Time
+RtspClient::GetStartupDelay()
+{
+  return m_qoe.GetStartupDelay();
+}
+
+uint32_t
+RtspClient::GetStallCount()
+{
+  return m_qoe.GetStallCount();
+}
+
+Time
+RtspClient::GetStallDuration()
+{
+  return m_qoe.GetStallDuration();
+}
+
+double
+RtspClient::GetRebufferRatio()
+{
+  return m_qoe.GetRebufferRatio();
+}
+
+double
+RtspClient::GetAverageBitrate()
+{
+  return m_qoe.GetAverageBitrate();
+}
+
+uint32_t
+RtspClient::GetQualitySwitches()
+{
+  return m_qoe.GetQualitySwitches();
+}
+
+Time
+RtspClient::GetPlayoutTarget()
+{
+  return m_playoutTarget;
+}
+
+//보관 중인 바이트, 컨테이너는 원소 크기 * 개수로 계산
+RtspMemoryUsage
+RtspClient::GetMemoryUsage()
+{
+  RtspMemoryUsage usage;
+  usage.jitterBuffer = m_jitterBuffer.GetFootprint();
+  usage.fec = m_fecWindow.capacity() * sizeof(FecEntry);
+  usage.control = sizeof(RtspClient) + m_nackPending.size() * NACK_ENTRY_SIZE;
+  if(m_rtspRxBuffer != 0)
+  {
+    usage.control += m_rtspRxBuffer->GetSize();
+  }
+  return usage;
+}
+
+uint64_t
+RtspClient::GetMemoryEvictedBytes()
+{
+  return m_memoryEvictedBytes;
+}
+
+//bytes를 더 할당할 수 있도록 상한 적용, 공간을 만들지 못하면 false
+//EVICT_OLDEST는 가장 오래된 NACK 대기 시퀀스부터 버림 (복구를 포기하고 실제 map 노드를 해제)
+bool
+RtspClient::EnforceMemoryLimit(uint64_t bytes)
+{
+  if(m_memoryLimit == 0)
+  {
+    return true;
+  }
+  uint64_t usage = GetMemoryUsage().GetTotal();
+  if(m_memoryLimitPolicy == EVICT_OLDEST)
+  {
+    while(usage + bytes > m_memoryLimit && !m_nackPending.empty())
+    {
+      NS_LOG_INFO("Client gave up NACK for seq " << m_nackPending.begin()->first
+                  << " over memory limit " << m_memoryLimit);
+      m_nackPending.erase(m_nackPending.begin());
+      usage -= NACK_ENTRY_SIZE;
+      m_memoryEvictedBytes += NACK_ENTRY_SIZE;
+    }
+  }
+  if(usage + bytes > m_memoryLimit)
+  {
+    m_memoryEvictedBytes += bytes;
+    return false;
+  }
+  return true;
+}
+
+//RTP 소켓을 address에 새로 바인드 (multicast 그룹 포트로 바꿀 때도 사용)
+void
+RtspClient::BindRtpSocket (const InetSocketAddress &address)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_rtpSocket != 0)
+    {
+      m_rtpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_rtpSocket->Close ();
+    }
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  m_rtpSocket = Socket::CreateSocket (GetNode (), tid);
+  if (m_rtpSocket->Bind (address) == -1)
+    {
+      NS_FATAL_ERROR ("Failed to bind socket");
+    }
+  m_rtpSocket->SetRecvCallback (MakeCallback (&RtspClient::HandleRtpReceive, this));
+}
+
 //RTSP handler
 void
 RtspClient::HandleRtspReceive (Ptr<Socket> socket)
 {
+  NS_LOG_FUNCTION(this << socket);
+
   Ptr<Packet> packet;
   while((packet = socket->Recv()))
   {
@@ -244,50 +595,113 @@ RtspClient::HandleRtspReceive (Ptr<Socket> socket)
     {
       break;
     }
-    uint8_t* msg = new uint8_t[packet->GetSize()+1];
-    packet->CopyData(msg, packet->GetSize());
-    std::istringstream res((char*)msg);
 
-    std::string method;
-    uint32_t responseStat;
+    //TCP 스트림을 RTSP 메시지 단위로 나눔
+    m_rtspRxBuffer->AddAtEnd(packet);
+    uint32_t messageSize;
+    while((messageSize = RtspHeader::PeekMessageSize(m_rtspRxBuffer)) != 0
+          && m_rtspRxBuffer->GetSize() >= messageSize)
+    {
+      RtspHeader response;
+      m_rtspRxBuffer->RemoveHeader(response);
+      HandleRtspResponse(response);
+    }
+  }
+}
 
-    res >> method >> responseStat;
+//RTSP 응답 처리
+void
+RtspClient::HandleRtspResponse (const RtspHeader &response)
+{
+  NS_LOG_FUNCTION(this << response);
 
-    if(responseStat == 200) 
+  if(response.GetStatus() == RtspHeader::OK) 
+  {
+    if(response.GetMethod() == RtspHeader::SETUP)
     {
-      if(method.compare("SETUP") == 0)
+      m_state = READY;
+      m_sessionId = response.GetSession();
+      m_framePeriod = response.GetFramePeriod();
+      m_frameCount = response.GetFrameCount();
+      m_lastFrameReceived = false;
+      if(m_statsCollector != 0)
       {
-        m_state = READY;
-        res >> m_framePeriod;
-        m_rtcpSendEvent = Simulator::Schedule(MilliSeconds(RtspClient::RTCP_PERIOD), &RtspClient::SendRtcpPacket, this);
+        m_statsCollector->SetSession(m_statsSlot, m_sessionId);
       }
-      else if(method.compare("PLAY") == 0)
-      {
-        m_state = PLAYING;
 
-        if(m_consumeEvent.IsExpired())
+      //multicast 응답이면 그룹 포트에서 RTP를 받음
+      //ns-3에는 IGMP가 없으므로 서버와 라우터에 정적 multicast 경로가 있어야 함 (RtspScenarioHelper 참고)
+      if(response.IsMulticast() && response.GetDestination() != m_multicastGroup)
+      {
+        m_multicastGroup = response.GetDestination();
+        BindRtpSocket(InetSocketAddress(Ipv4Address::GetAny(), response.GetClientRtpPort()));
+        NS_LOG_INFO("Client joined multicast group " << m_multicastGroup << " port " << response.GetClientRtpPort());
+      }
+      if(m_tickDriver != 0)
+      {
+        if(m_rtcpTick == RtspTickDriver::INVALID)
         {
-          m_consumeEvent = Simulator::Schedule(MilliSeconds(m_framePeriod*2), &RtspClient::ConsumeBuffer, this);
+          m_rtcpTick = m_tickDriver->Add(MilliSeconds(RtspClient::RTCP_PERIOD),
+                                         MakeCallback(&RtspClient::SendRtcpPacket, this),
+                                         MilliSeconds(RtspClient::RTCP_PERIOD));
         }
       }
-      else if(method.compare("PAUSE") == 0)
+      else
       {
-        m_state = READY;
-        Simulator::Cancel(m_consumeEvent);
+        m_rtcpSendEvent = Simulator::Schedule(MilliSeconds(RtspClient::RTCP_PERIOD), &RtspClient::SendRtcpPacket, this);
       }
-      else if(method.compare("TEARDOWN") == 0)
+    }
+    else if(response.GetMethod() == RtspHeader::PLAY)
+    {
+      m_state = PLAYING;
+
+      //adaptive playout은 목표 버퍼 깊이가 찰 때까지 매 프레임 주기마다 확인
+      if(m_consumeEvent.IsExpired() && m_consumeTick == RtspTickDriver::INVALID)
       {
-        m_state = INIT;
-        m_consumeEvent.Cancel();
-        m_rtcpSendEvent.Cancel();
+        m_buffering = m_adaptivePlayout;
+        Time delay = MilliSeconds(m_adaptivePlayout ? m_framePeriod : m_framePeriod*2);
+        if(m_tickDriver != 0)
+        {
+          m_consumeTick = m_tickDriver->Add(MilliSeconds(m_framePeriod),
+                                            MakeCallback(&RtspClient::ConsumeBuffer, this), delay);
+        }
+        else
+        {
+          m_consumeEvent = Simulator::Schedule(delay, &RtspClient::ConsumeBuffer, this);
+        }
       }
     }
-    else
+    else if(response.GetMethod() == RtspHeader::PAUSE)
     {
-      NS_LOG_ERROR("Client Rtsp: Parsing Error " << responseStat);
+      m_state = READY;
+      Simulator::Cancel(m_consumeEvent);
+      RemoveTick(m_consumeTick);
+
+      //PAUSE 구간은 stall로 세지 않음
+      Time stall = m_qoe.NotifyStop(Simulator::Now());
+      if(stall.IsStrictlyPositive())
+      {
+        m_stallTrace(stall);
+      }
+    }
+    else if(response.GetMethod() == RtspHeader::TEARDOWN)
+    {
+      m_state = INIT;
+      m_sessionId = 0;
+      m_consumeEvent.Cancel();
+      m_rtcpSendEvent.Cancel();
+      RemoveTick(m_consumeTick);
+      RemoveTick(m_rtcpTick);
+    }
+  }
+  else
+  {
+    NS_LOG_ERROR("Client Rtsp: " << RtspHeader::MethodToString(response.GetMethod())
+                 << " failed with " << response.GetStatus());
+    if(response.GetMethod() == RtspHeader::SETUP)
+    {
+      m_state = INIT;
     }
-    
-    delete msg;
   }
 }
 
@@ -302,39 +716,36 @@ RtspClient::SendRtspPacket (RtspClient::Method_t requestMethod, int64_t idx)
   NS_ASSERT (event.IsExpired ());
   NS_ASSERT (!Simulator::IsFinished());
 
-  std::ostringstream req;
+  RtspHeader request;
+  request.SetMethod(RtspHeader::Method_t(requestMethod));
+  request.SetCSeq(m_cseq++);
+  request.SetSession(m_sessionId);
 
-  //SETUP일 경우 파일명 붙임
+  //SETUP일 경우 파일명과 Transport 포트를 붙임
   if(requestMethod == SETUP)
   {
     m_state = READY;
-    req << "SETUP\n";
-    req << m_fileName;
+    request.SetUrl(m_fileName);
+    request.SetClientPorts(m_rtpPort, m_rtcpPort);
+    request.SetMulticast(m_multicast);
+    //서버가 첫 패킷부터 재전송용으로 보관하도록 NACK 사용을 알림
+    request.SetNack(m_enableNack);
   }
   else if(requestMethod == PLAY)
   {
-    req << "PLAY\n";
+    m_qoe.NotifyPlayRequest(Simulator::Now());
   }
   else if(requestMethod == PAUSE)
   {
     m_state = READY;
-    req << "PAUSE\n";
   }
   else if(requestMethod == TEARDOWN)
   {
     m_state = INIT;
-    req << "TEARDOWN\n";
-  }
-  else if(requestMethod == MODIFY)
-  {
-    req << "MODIFY\n";
-  }
-  else
-  {
-    NS_LOG_ERROR("Invalid method");
   }
 
-  Ptr<Packet> packet = Create<Packet>((uint8_t*)req.str().c_str(), 100);
+  Ptr<Packet> packet = Create<Packet>();
+  packet->AddHeader(request);
   int ret = m_rtspSocket->Send(packet);
 
   if (Ipv4Address::IsMatchingType (m_remoteAddress))
@@ -350,30 +761,61 @@ RtspClient::SendRtcpPacket()
 {
   NS_LOG_FUNCTION(this);
 
-  NS_ASSERT(m_rtcpSendEvent.IsExpired());
+  NS_ASSERT(m_tickDriver != 0 || m_rtcpSendEvent.IsExpired());
+
+  RtcpReceiverReportHeader report;
+  report.SetSenderSsrc(m_sessionId);
+  report.SetSourceSsrc(m_sessionId);
+  report.SetJitter(m_jitter);
+  if(m_delayCount > 0)
+  {
+    report.SetOneWayDelay(Time(m_delaySum.GetTimeStep() / m_delayCount));
+    m_delaySum = Time(0);
+    m_delayCount = 0;
+  }
+
+  //마지막 보고 이후 구간의 loss 비율 (RFC 3550 A.3)
+  double fractionLost = 0;
+  if(m_received > 0)
+  {
+    uint32_t expected = m_maxSeq - m_baseSeq + 1;
+    uint32_t expectedInterval = expected - m_expectedPrior;
+    uint32_t receivedInterval = m_received - m_receivedPrior;
+    m_expectedPrior = expected;
+    m_receivedPrior = m_received;
+    if(expectedInterval > receivedInterval)
+      fractionLost = double(expectedInterval - receivedInterval) / expectedInterval;
 
-  std::ostringstream req;
+    report.SetFractionLost(fractionLost);
+    report.SetCumulativeLost(int32_t(expected - m_received));
+    report.SetHighestSeq(m_maxSeq);
+    report.SetLastSr(m_lastRtpTs);
+    report.SetDelaySinceLastSr(Simulator::Now() - m_lastRtpArrival);
+  }
 
   if(m_state == PLAYING) {
-    if(m_frameCnt != m_lastSeq)
-      m_curFractionLost = ((float)m_cumLost - m_lastLost) / ((float)m_frameCnt - m_lastSeq);
-    m_curFractionLost = (m_curFractionLost * 0.85) + (m_lastFractionLost * 0.15);
-    req << m_curFractionLost;
+    m_curFractionLost = (fractionLost * 0.85) + (m_lastFractionLost * 0.15);
     m_fractionLossTrace(m_curFractionLost);
 
     m_lastFractionLost = m_curFractionLost;
   }
-  else {
-    req << 0;
-  }
-  m_lastLost = m_cumLost;
-  m_lastSeq = m_frameCnt;
 
-  Ptr<Packet> packet = Create<Packet>((uint8_t*)req.str().c_str(), 100);
+  Ptr<Packet> packet = Create<Packet>();
+  packet->AddHeader(report);
   m_rtcpSocket->Send(packet);
 
-  NS_LOG_INFO("Client Rtcp Send: " << req.str());
-  m_rtcpSendEvent = Simulator::Schedule(MilliSeconds(RtspClient::RTCP_PERIOD), &RtspClient::SendRtcpPacket, this);
+  NS_LOG_INFO("Client Rtcp Send: " << report);
+
+  //복구되지 않은 손실 패킷은 RTCP 주기마다 다시 요청
+  if(m_enableNack && !m_nackPending.empty())
+  {
+    SendNack();
+  }
+  //공유 tick 드라이버가 있으면 드라이버가 다음 주기에 다시 호출
+  if(m_tickDriver == 0)
+  {
+    m_rtcpSendEvent = Simulator::Schedule(MilliSeconds(RtspClient::RTCP_PERIOD), &RtspClient::SendRtcpPacket, this);
+  }
 }
 
 //RTP handler
@@ -382,26 +824,247 @@ RtspClient::HandleRtpReceive(Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
 
+  //페이로드는 복사하지 않고 헤더와 크기만 읽음
   Ptr<Packet> packet;
-  Address from;
-  Address localAddress;
-  while ((packet = socket->RecvFrom (from)))
+  RtpHeader header;
+  bool newLoss = false;
+  while ((packet = socket->Recv ()))
   {
-    socket->GetSockName (localAddress);
+    packet->PeekHeader(header);
+    if(header.GetPayloadType() == RtpFecHeader::PAYLOAD_TYPE)
+    {
+      newLoss |= HandleFecPacket(packet);
+    }
+    else
+    {
+      newLoss |= ProcessRtpPacket(packet, header, false);
+    }
+  }
 
-    SeqTsHeader header;
-    packet->RemoveHeader(header);
+  if(newLoss)
+  {
+    SendNack();
+  }
+}
 
+//RTP 패킷 하나를 수신 통계와 프레임 버퍼에 반영, 새 손실이 발견되면 true 반환
+//recovered는 FEC로 복원한 패킷
+bool
+RtspClient::ProcessRtpPacket(Ptr<Packet> packet, const RtpHeader &header, bool recovered)
+{
+    uint32_t payloadSize = packet->GetSize() - header.GetSerializedSize();
+    uint32_t frameId = header.GetFrameId();
     uint32_t seq = header.GetSeq();
 
-    std::ostringstream strout;
-    packet->CopyData(&strout, packet->GetSize());
+    //중복 검사용으로 시퀀스와 길이를 보관, 이미 받은 시퀀스는 중복이므로 버림
+    FecEntry &fecEntry = m_fecWindow[seq % m_fecWindow.size()];
+    if(fecEntry.valid && fecEntry.seq == seq)
+    {
+      NS_LOG_LOGIC("Client Rtp duplicate seq " << seq);
+      return false;
+    }
+    fecEntry.valid = true;
+    fecEntry.seq = seq;
+    fecEntry.length = payloadSize;
+    //FEC를 언제 받기 시작하든 첫 묶음부터 복원할 수 있도록 헤더 바이트는 항상 보관
+    NS_ASSERT(header.GetSerializedSize() == FEC_HEADER_SIZE);
+    packet->CopyData(fecEntry.header, FEC_HEADER_SIZE);
+
+    if(!recovered)
+    {
+      m_rxSize += payloadSize;
+      if(m_statsCollector != 0)
+      {
+        m_statsCollector->AddPacket(m_statsSlot, payloadSize);
+        if(m_received > 0 && seq > m_maxSeq + 1)
+        {
+          m_statsCollector->AddLoss(m_statsSlot, seq - m_maxSeq - 1);
+        }
+      }
+    }
+
+    //시퀀스 공백은 NACK 대기 목록에 추가, 재전송된 패킷은 목록에서 제거
+    bool newLoss = false;
+    bool retransmitted = false;
+    if(m_enableNack && m_received > 0 && seq > m_maxSeq + 1)
+    {
+      for(uint32_t lost = std::max(m_maxSeq + 1, seq - std::min(seq, MAX_NACK_PENDING)); lost < seq; lost++)
+      {
+        if(!EnforceMemoryLimit(NACK_ENTRY_SIZE))
+        {
+          NS_LOG_INFO("Client skipped NACK for seq " << lost << " over memory limit " << m_memoryLimit);
+          continue;
+        }
+        m_nackPending[lost] = 0;
+      }
+      while(m_nackPending.size() > MAX_NACK_PENDING)
+      {
+        m_nackPending.erase(m_nackPending.begin());
+      }
+      newLoss = true;
+    }
+    else if(m_received > 0 && seq < m_maxSeq)
+    {
+      auto pending = m_nackPending.find(seq);
+      if(pending != m_nackPending.end())
+      {
+        m_nackPending.erase(pending);
+        if(!recovered)
+        {
+          m_recoveredPackets++;
+          retransmitted = true;
+          NS_LOG_INFO("Client Rtp recovered seq " << seq);
+        }
+      }
+    }
+
+    //RTCP 수신 통계, 복구된 패킷은 세지 않아 RR에는 복구 전 loss가 보고됨
+    if(m_received == 0 || seq < m_baseSeq)
+    {
+      m_baseSeq = seq;
+    }
+    if(m_received == 0 || seq > m_maxSeq)
+    {
+      m_maxSeq = seq;
+      m_lastRtpTs = header.GetTs();
+      m_lastRtpArrival = Simulator::Now();
+    }
+
+    //one-way delay와 interarrival jitter (RFC 3550 6.4.1)
+    //복구된 패킷은 원래 전송 시각을 가지므로 delay 통계에서 제외
+    if(!recovered && !retransmitted)
+    {
+      Time transit = Simulator::Now() - header.GetTs();
+      if(m_received > 0)
+      {
+        m_jitter += Time((Abs(transit - m_lastTransit) - m_jitter).GetTimeStep() / 16);
+      }
+      m_lastTransit = transit;
+      m_oneWayDelay = transit;
+      m_delaySum += transit;
+      m_delayCount++;
+      m_received++;
+      m_oneWayDelayTrace(transit);
+      m_jitterTrace(m_jitter);
+    }
+
+    if(header.GetRepresentation() != m_representation)
+    {
+      m_representation = header.GetRepresentation();
+      NS_LOG_INFO("Client representation changed to " << m_representation << " at frame " << frameId);
+      m_representationTrace(m_representation);
+    }
+
+    if(m_frameCount > 0 && frameId + 1 >= m_frameCount)
+    {
+      m_lastFrameReceived = true;
+    }
+
+    //조각을 프레임 버퍼에 기록, 이미 재생 시점이 지난 프레임의 조각은 버림
+    RtpJitterBuffer::Entry *entry = 0;
+    if(frameId < m_frame
+       || (entry = m_jitterBuffer.Insert(frameId, header.GetFragmentCount(), payloadSize, Simulator::Now())) == 0)
+    {
+      NS_LOG_INFO("Client Rtp late fragment of frame " << frameId);
+      return newLoss;
+    }
+    entry->frameType = header.GetFrameType();
+    entry->reference = frameId - header.GetReferenceDistance();
+    entry->representation = header.GetRepresentation();
+
+    NS_LOG_INFO("client seq: " << header.GetSeq() << " frame: " << frameId
+                << " fragment: " << header.GetFragmentIndex() << "/" << header.GetFragmentCount());
+    NS_LOG_INFO("Client Rtp Recv: " << payloadSize);
+    return newLoss;
+}
+
+//FEC 패킷 처리, 묶음에서 패킷 하나만 손실되었으면 XOR로 복원
+bool
+RtspClient::HandleFecPacket(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    RtpHeader fecRtp;
+    packet->RemoveHeader(fecRtp);
+    RtpFecHeader fec;
+    packet->RemoveHeader(fec);
     m_rxSize += packet->GetSize();
 
-    m_frameMap[seq] = strout.str();
-    NS_LOG_INFO("client seq: "<<seq);
-    NS_LOG_INFO("Client Rtp Recv: " << packet->GetSize());
+    std::vector<uint8_t> header = fec.GetHeaderRecovery();
+    if(fec.GetCount() == 0 || fec.GetCount() > m_fecWindow.size() || header.size() != FEC_HEADER_SIZE)
+    {
+      return false;
+    }
+
+    uint16_t length = fec.GetLengthRecovery();
+    uint32_t missing = 0;
+    uint32_t missingSeq = 0;
+    for(uint32_t seq = fec.GetBaseSeq(); seq != fec.GetBaseSeq() + fec.GetCount(); seq++)
+    {
+      const FecEntry &entry = m_fecWindow[seq % m_fecWindow.size()];
+      if(!entry.valid || entry.seq != seq)
+      {
+        missing++;
+        missingSeq = seq;
+        continue;
+      }
+      for(uint32_t idx = 0; idx < FEC_HEADER_SIZE; idx++)
+      {
+        header[idx] ^= entry.header[idx];
+      }
+      length ^= entry.length;
+    }
+    if(missing != 1)
+    {
+      return false;
+    }
+
+    //복원한 헤더 바이트로 RTP 패킷을 다시 만듦
+    Ptr<Packet> recovered = Create<Packet>(header.data(), header.size());
+    RtpHeader rtp;
+    recovered->RemoveHeader(rtp);
+    if(rtp.GetSeq() != missingSeq)
+    {
+      NS_LOG_WARN("Client Rtp FEC recovered unexpected seq " << rtp.GetSeq());
+      return false;
+    }
+    recovered = Create<Packet>(length);
+    recovered->AddHeader(rtp);
+    m_fecRecoveredPackets++;
+    NS_LOG_INFO("Client Rtp FEC recovered seq " << missingSeq);
+    return ProcessRtpPacket(recovered, rtp, true);
+}
+
+//NACK 대기 중인 시퀀스에 대해 RTCP NACK 전송 (RFC 4585 Generic NACK)
+void
+RtspClient::SendNack()
+{
+  NS_LOG_FUNCTION(this);
+
+  RtcpNackHeader nack;
+  nack.SetSenderSsrc(m_sessionId);
+  nack.SetMediaSsrc(m_sessionId);
+  for(auto it = m_nackPending.begin(); it != m_nackPending.end(); )
+  {
+    //최대 횟수만큼 보낸 시퀀스는 포기
+    if(it->second >= m_maxNackRetries)
+    {
+      it = m_nackPending.erase(it);
+      continue;
+    }
+    it->second++;
+    nack.AddLostSequence(it->first & 0xffff);
+    ++it;
   }
+  if(nack.GetItemCount() == 0)
+  {
+    return;
+  }
+
+  Ptr<Packet> packet = Create<Packet>();
+  packet->AddHeader(nack);
+  m_rtcpSocket->Send(packet);
+  NS_LOG_INFO("Client Rtcp Send: " << nack);
 }
 
 //일정한 간격에 맞게 프레임 소비
@@ -410,32 +1073,154 @@ RtspClient::ConsumeBuffer()
 {
   NS_LOG_FUNCTION(this);
 
-  NS_ASSERT(m_consumeEvent.IsExpired());
+  NS_ASSERT(m_tickDriver != 0 || m_consumeEvent.IsExpired());
+
+  //스트림의 마지막 프레임까지 재생했거나, 마지막 프레임까지 받았는데 버퍼가 비었으면 재생 종료
+  //이후로는 프레임이 오지 않으므로 stall로 세지 않고 타이머를 멈춤
+  if(m_state == PLAYING && m_frameCount > 0
+     && (m_frame >= m_frameCount || (m_lastFrameReceived && m_jitterBuffer.FindNext(m_frame) == 0)))
+  {
+    NS_LOG_INFO("Playback reached the end of the stream at frame " << m_frame);
+    Time stall = m_qoe.NotifyStop(Simulator::Now());
+    if(stall.IsStrictlyPositive())
+    {
+      m_stallTrace(stall);
+    }
+    RemoveTick(m_consumeTick);
+    return;
+  }
+
+  //목표 버퍼 깊이가 찰 때까지 재생을 멈춤, 재생 시작 후라면 stall로 셈
+  if(m_state == PLAYING && m_buffering)
+  {
+    UpdatePlayoutTarget();
+    if(GetBufferDepth() < m_playoutTarget)
+    {
+      if(m_qoe.NotifyFrameMissing(Simulator::Now()) && m_statsCollector != 0)
+      {
+        m_statsCollector->AddStall(m_statsSlot);
+      }
+      if(m_tickDriver == 0)
+      {
+        m_consumeEvent = Simulator::Schedule( MilliSeconds(m_framePeriod), &RtspClient::ConsumeBuffer, this );
+      }
+      return;
+    }
+    m_buffering = false;
+    NS_LOG_INFO("Playout buffer reached " << GetBufferDepth().GetMilliSeconds() << "ms, target "
+                << m_playoutTarget.GetMilliSeconds() << "ms");
+  }
 
-  auto frame = m_frameMap.begin();
   if(m_state == PLAYING)
   {
     //다음 프레임이 있다면 다음 프레임을 바로 재생함
-    if((frame = m_frameMap.lower_bound(m_frame)) == m_frameMap.end())
+    RtpJitterBuffer::Entry *frame = m_jitterBuffer.FindNext(m_frame);
+    if(frame == 0)
     {
       NS_LOG_INFO("Buffering occurs at: " << m_frame);
       m_cumLost++;
+      m_buffering = m_adaptivePlayout;
+      if(m_qoe.NotifyFrameMissing(Simulator::Now()))
+      {
+        NS_LOG_INFO("Stall started at: " << m_frame);
+        if(m_statsCollector != 0)
+        {
+          m_statsCollector->AddStall(m_statsSlot);
+        }
+      }
     }
     else
     {
-      m_frame = frame->first;
-      NS_LOG_INFO("Consumed Frame: " << m_frame);
+      m_frame = frame->frameId;
+      //참조하는 앵커 프레임이 디코딩되어 있어야 디코딩 가능
+      //앵커가 손실되면 다음 I 프레임까지 GOP의 나머지 프레임은 디코딩되지 않음
+      bool referenceValid = frame->reference == frame->frameId
+                            || (m_hasDecodedAnchor && m_lastDecodedAnchor == frame->reference);
+      bool decoded = frame->IsComplete() && referenceValid;
+
+      //QoE 지표 갱신, 디코딩된 프레임 바이트만 비트레이트에 반영
+      bool started = m_qoe.HasStarted();
+      uint32_t representation = m_qoe.GetRepresentation();
+      Time stall = m_qoe.NotifyFramePlayed(Simulator::Now(), MilliSeconds(m_framePeriod),
+                                           decoded ? frame->size : 0, frame->representation);
+      if(!started)
+      {
+        m_startupDelayTrace(m_qoe.GetStartupDelay());
+      }
+      else if(m_qoe.GetRepresentation() != representation)
+      {
+        m_qualitySwitchTrace(representation, m_qoe.GetRepresentation());
+      }
+      if(stall.IsStrictlyPositive())
+      {
+        m_stallTrace(stall);
+      }
+
+      if(decoded)
+      {
+        m_goodputSize += frame->size;
+        m_decodedFrames++;
+        if(frame->frameType != RtspFrameTrace::B_FRAME)
+        {
+          m_lastDecodedAnchor = frame->frameId;
+          m_hasDecodedAnchor = true;
+        }
+        NS_LOG_INFO("Consumed Frame: " << m_frame);
+      }
+      else if(frame->IsComplete())
+      {
+        m_undecodableFrames++;
+        NS_LOG_INFO("Undecodable Frame: " << m_frame << " (reference " << frame->reference << " lost)");
+      }
+      else
+      {
+        m_partialFrames++;
+        NS_LOG_INFO("Consumed Partial Frame: " << m_frame << " ("
+                    << frame->fragments << "/" << frame->fragmentCount << ")");
+      }
       
       //모든 이전프레임 삭제
-      auto begin = m_frameMap.begin();
-      for(;frame != begin; frame--)
-        m_frameMap.erase(frame);
-      m_frameMap.erase(begin);
       m_frame++;
+      m_jitterBuffer.DiscardBefore(m_frame);
     }
     m_frameCnt++;
   }
-  m_consumeEvent = Simulator::Schedule( MilliSeconds(m_framePeriod), &RtspClient::ConsumeBuffer, this );
+  if(m_tickDriver == 0)
+  {
+    m_consumeEvent = Simulator::Schedule( MilliSeconds(m_framePeriod), &RtspClient::ConsumeBuffer, this );
+  }
+}
+
+//공유 tick 드라이버에서 타이머 제거
+void
+RtspClient::RemoveTick(uint32_t &tick)
+{
+  if(m_tickDriver != 0 && tick != RtspTickDriver::INVALID)
+  {
+    m_tickDriver->Remove(tick);
+  }
+  tick = RtspTickDriver::INVALID;
+}
+
+//재생 시점 이후로 버퍼에 있는 프레임의 재생 시간
+Time
+RtspClient::GetBufferDepth()
+{
+  return MilliSeconds(uint64_t(m_jitterBuffer.GetSize()) * m_framePeriod);
+}
+
+//목표 버퍼 깊이 = 기본 목표 + jitter * 배수, [하한, 상한]으로 제한
+void
+RtspClient::UpdatePlayoutTarget()
+{
+  Time target = m_playoutBase + Time(int64_t(m_jitter.GetTimeStep() * m_playoutJitterFactor));
+  target = std::max(target, m_minPlayoutTarget);
+  target = std::min(target, m_maxPlayoutTarget);
+  if(target != m_playoutTarget)
+  {
+    NS_LOG_LOGIC("Playout target changed to " << target.GetMilliSeconds() << "ms");
+    m_playoutTarget = target;
+  }
 }
 
 }
\ No newline at end of file
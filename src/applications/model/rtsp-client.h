@@ -18,8 +18,18 @@ IPv6는 지원하지 않습니다.
 #include <ns3/address.h>
 #include <ns3/traced-callback.h>
 #include <ns3/socket.h>
+#include <ns3/inet-socket-address.h>
+#include <ns3/rtp-jitter-buffer.h>
+#include <ns3/rtsp-frame-trace.h>
+#include <ns3/rtp-header.h>
+#include <ns3/rtsp-header.h>
+#include <ns3/rtsp-qoe-metrics.h>
+#include <ns3/rtsp-stats-collector.h>
+#include <ns3/rtsp-tick-driver.h>
+#include <ns3/rtsp-memory-usage.h>
 #include <ostream>
 #include <map>
+#include <vector>
 #include <queue>
 
 namespace ns3 {
@@ -42,16 +52,53 @@ public:
     enum Method_t
     {
         //rtsp message types
-        SETUP,
-        PLAY,
-        PAUSE,
-        TEARDOWN,
-        MODIFY,
+        SETUP = RtspHeader::SETUP,
+        PLAY = RtspHeader::PLAY,
+        PAUSE = RtspHeader::PAUSE,
+        TEARDOWN = RtspHeader::TEARDOWN,
+        MODIFY = RtspHeader::MODIFY,
+    };
+
+    enum MemoryLimitPolicy_t
+    {
+        //메모리가 MemoryLimit을 넘을 때 NACK 대기 목록 처리
+        //(지터 버퍼 링과 FEC 윈도우는 고정 크기라 StartApplication에서 상한에 맞게 지터 버퍼 용량을 줄임)
+        EVICT_OLDEST,                        //가장 오래된 NACK 대기 시퀀스부터 버림
+        DROP_NEWEST,                         //새 손실 시퀀스를 NACK 대기 목록에 넣지 않음
     };
 
     void ScheduleMessage (Time time, Method_t requestMethod);
     uint64_t GetRxSize();
+    uint64_t GetGoodputSize();
+    uint32_t GetPartialFrames();
+    uint32_t GetDecodedFrames();
+    uint32_t GetUndecodableFrames();
+    uint32_t GetRecoveredPackets();
+    uint32_t GetFecRecoveredPackets();
     double GetFractionLost();
+    Time GetJitter();
+    Time GetOneWayDelay();
+
+    //QoE 지표
+    const RtspQoeMetrics &GetQoeMetrics();
+    Time GetStartupDelay();
+    uint32_t GetStallCount();
+    Time GetStallDuration();
+    double GetRebufferRatio();
+    double GetAverageBitrate();
+    uint32_t GetQualitySwitches();
+    //adaptive playout의 현재 목표 버퍼 깊이
+    Time GetPlayoutTarget();
+
+    //메모리 사용량
+    RtspMemoryUsage GetMemoryUsage();
+    //메모리 상한 때문에 해제하거나 보관하지 않은 바이트
+    uint64_t GetMemoryEvictedBytes();
+
+    //representation 변경 트레이스 (새 representation 번호)
+    typedef void (* RepresentationTracedCallback)(uint32_t representation);
+    //재생된 프레임의 representation 변경 트레이스 (이전, 새 representation 번호)
+    typedef void (* QualitySwitchTracedCallback)(uint32_t from, uint32_t to);
 private:
     /**************************************************
     *                   소켓 콜백
@@ -70,9 +117,18 @@ private:
     virtual void StartApplication();
     virtual void StopApplication();
 
+    void HandleRtspResponse(const RtspHeader &response);
     void SendRtspPacket(Method_t requestMethod, int64_t idx);
     void SendRtcpPacket();
+    void SendNack();
+    void BindRtpSocket(const InetSocketAddress &address);
+    bool ProcessRtpPacket(Ptr<Packet> packet, const RtpHeader &header, bool recovered);
+    bool HandleFecPacket(Ptr<Packet> packet);
     void ConsumeBuffer();
+    Time GetBufferDepth();
+    void UpdatePlayoutTarget();
+    void RemoveTick(uint32_t &tick);
+    bool EnforceMemoryLimit(uint64_t bytes);
 
 
     /**************************************************
@@ -87,22 +143,75 @@ private:
     uint16_t m_rtpPort;                      // RTP 포트
     uint16_t m_rtcpPort;                     // RTCP 포트
     uint16_t m_rtspPort;                     // RTSP 포트
+    bool m_multicast;                        // SETUP에서 multicast 전송을 요청할지 여부
+    Ipv4Address m_multicastGroup;            // 서버가 알려준 multicast 그룹, unicast면 Any
 
     State_t m_state;                         // 클라이언트 상태
+    uint32_t m_cseq;                         // 다음 RTSP 요청의 CSeq
+    uint32_t m_sessionId;                    // SETUP 응답으로 받은 세션 ID
+    Ptr<Packet> m_rtspRxBuffer;              // RTSP 수신 버퍼 (메시지 단위로 나누기 전)
 
-    std::map<uint32_t, std::string> m_frameMap; // RTP 프레임 버퍼
+    RtpJitterBuffer m_jitterBuffer;          // RTP 프레임 버퍼 (프레임 번호 별 링 버퍼)
+    uint32_t m_jitterBufferCapacity;         // 프레임 버퍼 용량 (프레임 수)
+    uint64_t m_memoryLimit;                  // 메모리 상한 (바이트), 0이면 제한 없음
+    MemoryLimitPolicy_t m_memoryLimitPolicy; // 상한을 넘을 때의 처리
+    uint64_t m_memoryEvictedBytes;           // 상한 때문에 해제하거나 보관하지 않은 바이트
 
     const static int RTCP_PERIOD = 400;      // RTCP 전송 주기
+    const static uint32_t MAX_NACK_PENDING = 512; // NACK 대기 중으로 보관하는 최대 시퀀스 수
+    // NACK 대기 목록 원소 하나의 크기 (map 노드: 값 + 포인터 3개 + 색)
+    const static uint32_t NACK_ENTRY_SIZE = sizeof(std::pair<const uint32_t, uint32_t>) + 4 * sizeof(void *);
+
+    bool m_enableNack;                       // 손실 패킷에 대해 NACK을 보낼지 여부
+    uint32_t m_maxNackRetries;               // 시퀀스 하나에 대해 NACK을 보내는 최대 횟수
+    std::map<uint32_t, uint32_t> m_nackPending; // 아직 복구되지 않은 손실 시퀀스, NACK 보낸 횟수
+    uint32_t m_recoveredPackets;             // 재전송으로 복구한 패킷 수
+
+    // FEC 복원용으로 보관하는 최근 RTP 패킷
+    const static uint32_t FEC_HEADER_SIZE = 26;  // 직렬화된 RtpHeader 크기
+    struct FecEntry
+    {
+      uint32_t seq;                          // RTP 시퀀스
+      uint16_t length;                       // 페이로드 길이
+      bool valid;                            // 슬롯 사용 여부
+      uint8_t header[FEC_HEADER_SIZE];       // 직렬화된 RtpHeader
+      FecEntry () : seq (0), length (0), valid (false) {}
+    };
+    const static uint32_t FEC_WINDOW = 512;  // 보관하는 최근 RTP 패킷 수
+    std::vector<FecEntry> m_fecWindow;       // seq % FEC_WINDOW로 인덱싱, 중복 수신 검사에도 사용
+    uint32_t m_fecRecoveredPackets;          // FEC로 복원한 패킷 수
 
     float m_lastFractionLost;                // 마지막 loss 비율
     float m_curFractionLost;                 // 현재 loss 비율
-    uint32_t m_lastSeq;                      // RTCP를 마지막으로 보냈을 때의 RTP 시퀀스
-    uint32_t m_lastLost;                     // RTCP를 마지막으로 보냈을 때의 RTP 누적 loss
-    uint32_t m_cumLost;                      // 누적 loss 시퀀스
+    uint32_t m_cumLost;                      // 재생 시점에 프레임이 없었던 횟수
+
+    // RTCP 수신 통계 (RFC 3550 A.3)
+    uint32_t m_baseSeq;                      // 처음 받은 RTP 시퀀스
+    uint32_t m_maxSeq;                       // 받은 가장 큰 RTP 시퀀스
+    uint32_t m_received;                     // 받은 RTP 패킷 수
+    uint32_t m_expectedPrior;                // 마지막 RTCP 때 기대한 패킷 수
+    uint32_t m_receivedPrior;                // 마지막 RTCP 때 받은 패킷 수
+    Time m_lastRtpTs;                        // 마지막 RTP 패킷의 전송 시각 (LSR)
+    Time m_lastRtpArrival;                   // 마지막 RTP 패킷의 도착 시각 (DLSR)
+    Time m_jitter;                           // interarrival jitter (RFC 3550 6.4.1)
+    Time m_lastTransit;                      // 마지막 RTP 패킷의 전송 지연 (도착 - 전송 시각)
+    Time m_oneWayDelay;                      // 마지막 RTP 패킷의 one-way delay
+    Time m_delaySum;                         // 마지막 RTCP 이후 one-way delay 합
+    uint32_t m_delayCount;                   // 마지막 RTCP 이후 delay 샘플 수
 
     uint32_t m_framePeriod;                  // 1초 / 프레임 레이트
     uint32_t m_frameCnt;                     // 시간을 프레임 단위로 나타냄  
     uint32_t m_frame;                        // 재생 중 프레임
+    uint32_t m_frameCount;                   // SETUP 응답으로 받은 스트림의 프레임 수, 모르면 0
+    bool m_lastFrameReceived;                // 스트림 마지막 프레임의 조각을 받았는지 여부
+
+    bool m_adaptivePlayout;                  // 버퍼 깊이가 목표에 도달하면 재생을 시작/재개할지 여부
+    bool m_buffering;                        // 목표 버퍼 깊이까지 채우는 중
+    Time m_playoutBase;                      // jitter가 없을 때의 목표 버퍼 깊이
+    Time m_minPlayoutTarget;                 // 목표 버퍼 깊이 하한
+    Time m_maxPlayoutTarget;                 // 목표 버퍼 깊이 상한
+    double m_playoutJitterFactor;            // 목표 버퍼 깊이에 더하는 jitter 배수
+    Time m_playoutTarget;                    // 현재 목표 버퍼 깊이
 
     std::string m_fileName;                  // 비디오 파일 이름
     
@@ -110,10 +219,32 @@ private:
     std::vector<EventId> m_rtspSendEvents;   // RTSP 전송 예약 이벤트
     EventId m_consumeEvent;                  // 프레임 소모 이벤트
     EventId m_rtcpSendEvent;                 // RTCP 전송 이벤트
+    Ptr<RtspTickDriver> m_tickDriver;        // 공유 tick 드라이버, 없으면 위의 이벤트 사용
+    uint32_t m_consumeTick;                  // 드라이버에 등록된 프레임 소모 타이머
+    uint32_t m_rtcpTick;                     // 드라이버에 등록된 RTCP 전송 타이머
 
     uint64_t m_rxSize;                       // throughput
+    uint64_t m_goodputSize;                  // 완전히 수신되어 재생된 프레임 바이트
+    uint32_t m_partialFrames;                // 일부 조각만 수신된 채로 재생된 프레임 수
+    uint32_t m_decodedFrames;                // 디코딩되어 재생된 프레임 수
+    uint32_t m_undecodableFrames;            // 완전히 수신했지만 참조 프레임이 없어 디코딩하지 못한 프레임 수
+    uint32_t m_lastDecodedAnchor;            // 마지막으로 디코딩된 앵커(I/P) 프레임
+    bool m_hasDecodedAnchor;                 // 디코딩된 앵커 프레임이 있는지 여부
+    uint32_t m_representation;               // 마지막으로 받은 RTP 패킷의 representation
+
+    RtspQoeMetrics m_qoe;                    // 재생 QoE 지표
+    bool m_printQoe;                         // StopApplication에서 QoE 지표를 출력할지 여부
+
+    Ptr<RtspStatsCollector> m_statsCollector; // 통계 수집기, 없으면 0
+    uint32_t m_statsSlot;                    // 수집기에 등록된 슬롯
 
     ns3::TracedCallback<float &> m_fractionLossTrace; // fractionLoss 트레이스
+    ns3::TracedCallback<Time> m_jitterTrace;          // jitter 트레이스
+    ns3::TracedCallback<Time> m_oneWayDelayTrace;     // one-way delay 트레이스
+    ns3::TracedCallback<uint32_t> m_representationTrace; // representation 변경 트레이스
+    ns3::TracedCallback<Time> m_startupDelayTrace;    // 첫 프레임 재생 시 startup delay 트레이스
+    ns3::TracedCallback<Time> m_stallTrace;           // stall이 끝날 때 stall 길이 트레이스
+    ns3::TracedCallback<uint32_t, uint32_t> m_qualitySwitchTrace; // 재생 품질 변경 트레이스
 };
 
 }
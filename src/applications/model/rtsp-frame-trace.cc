@@ -0,0 +1,296 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-frame-trace.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE("RtspFrameTrace");
+
+namespace ns3 {
+
+const char RtspFrameTrace::MAGIC[8] = { 'R', 'T', 'S', 'P', 'T', 'R', 'C', '1' };
+const char RtspFrameTrace::MAGIC_TYPED[8] = { 'R', 'T', 'S', 'P', 'T', 'R', 'C', '2' };
+
+std::map<std::string, RtspFrameTrace *> &
+RtspFrameTrace::GetCache ()
+{
+  static std::map<std::string, RtspFrameTrace *> cache;
+  return cache;
+}
+
+Ptr<RtspFrameTrace>
+RtspFrameTrace::Load (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (fileName);
+
+  //이미 읽은 트레이스는 공유
+  std::map<std::string, RtspFrameTrace *> &cache = GetCache ();
+  auto it = cache.find (fileName);
+  if (it != cache.end ())
+    {
+      return Ptr<RtspFrameTrace> (it->second);
+    }
+
+  Ptr<RtspFrameTrace> trace = Ptr<RtspFrameTrace> (new RtspFrameTrace (fileName), false);
+  if (!trace->LoadBinary () && !trace->LoadText ())
+    {
+      NS_LOG_ERROR ("Failed to load frame trace " << fileName);
+      return 0;
+    }
+  cache[fileName] = PeekPointer (trace);
+
+  NS_LOG_INFO ("Frame trace " << fileName << " loaded: " << trace->m_count << " frames"
+               << (trace->IsMapped () ? " (mapped)" : ""));
+  return trace;
+}
+
+bool
+RtspFrameTrace::ConvertToBinary (const std::string &textFile, const std::string &binaryFile)
+{
+  NS_LOG_FUNCTION (textFile << binaryFile);
+
+  Ptr<RtspFrameTrace> trace = Load (textFile);
+  if (trace == 0)
+    {
+      return false;
+    }
+
+  std::ofstream out (binaryFile.c_str (), std::ios::binary | std::ios::trunc);
+  if (!out.is_open ())
+    {
+      NS_LOG_ERROR ("Failed to open " << binaryFile);
+      return false;
+    }
+  out.write (trace->HasFrameTypes () ? MAGIC_TYPED : MAGIC, sizeof (MAGIC));
+  out.write ((const char *) &trace->m_count, sizeof (trace->m_count));
+  out.write ((const char *) trace->m_frames, trace->m_count * sizeof (uint32_t));
+  if (trace->HasFrameTypes ())
+    {
+      out.write ((const char *) trace->m_types, trace->m_count);
+    }
+  return out.good ();
+}
+
+RtspFrameTrace::RtspFrameTrace (const std::string &fileName)
+  : m_fileName (fileName),
+    m_frames (0),
+    m_types (0),
+    m_count (0),
+    m_totalBytes (0),
+    m_mapBase (0),
+    m_mapLength (0)
+{
+  NS_LOG_FUNCTION (this << fileName);
+}
+
+RtspFrameTrace::~RtspFrameTrace ()
+{
+  NS_LOG_FUNCTION (this);
+
+  //마지막 참조가 사라지면 캐시에서 제거
+  std::map<std::string, RtspFrameTrace *> &cache = GetCache ();
+  auto it = cache.find (m_fileName);
+  if (it != cache.end () && it->second == this)
+    {
+      cache.erase (it);
+    }
+  if (m_mapBase != 0)
+    {
+      munmap (m_mapBase, m_mapLength);
+    }
+}
+
+//바이너리 형식: MAGIC(8) | 프레임 개수(4) | 프레임 크기(4) * 개수 [| 프레임 타입(1) * 개수]
+//프레임 타입은 MAGIC_TYPED 파일에만 있음
+bool
+RtspFrameTrace::LoadBinary ()
+{
+  int fd = open (m_fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+
+  struct stat st;
+  const size_t headerSize = sizeof (MAGIC) + sizeof (uint32_t);
+  if (fstat (fd, &st) != 0 || (size_t) st.st_size < headerSize)
+    {
+      close (fd);
+      return false;
+    }
+
+  void *base = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (base == MAP_FAILED)
+    {
+      return false;
+    }
+
+  const char *data = (const char *) base;
+  uint32_t count;
+  std::memcpy (&count, data + sizeof (MAGIC), sizeof (count));
+  bool typed = std::memcmp (data, MAGIC_TYPED, sizeof (MAGIC_TYPED)) == 0;
+  size_t expected = headerSize + (size_t) count * (sizeof (uint32_t) + (typed ? 1 : 0));
+  if ((!typed && std::memcmp (data, MAGIC, sizeof (MAGIC)) != 0)
+      || (size_t) st.st_size != expected)
+    {
+      munmap (base, st.st_size);
+      return false;
+    }
+
+  m_mapBase = base;
+  m_mapLength = st.st_size;
+  m_frames = (const uint32_t *) (data + headerSize);
+  m_count = count;
+  if (typed)
+    {
+      m_types = (const uint8_t *) (data + headerSize + (size_t) count * sizeof (uint32_t));
+      //텍스트 형식과 같이 I/P/B가 아닌 타입은 거부
+      for (uint32_t i = 0; i < m_count; i++)
+        {
+          if (m_types[i] > B_FRAME)
+            {
+              NS_FATAL_ERROR ("Invalid frame type " << (uint32_t) m_types[i] << " at frame " << i
+                              << " in " << m_fileName);
+            }
+        }
+    }
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      m_totalBytes += m_frames[i];
+    }
+  BuildReferences ();
+  return true;
+}
+
+bool
+RtspFrameTrace::LoadText ()
+{
+  std::ifstream in (m_fileName.c_str ());
+  if (!in.is_open ())
+    {
+      return false;
+    }
+
+  bool typed = false;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      std::istringstream fields (line);
+      uint32_t frameSize;
+      if (!(fields >> frameSize))
+        {
+          continue;
+        }
+      char type = 'P';
+      if (fields >> type)
+        {
+          typed = true;
+        }
+
+      m_sizes.push_back (frameSize);
+      m_totalBytes += frameSize;
+      switch (type)
+        {
+        case 'I':
+        case 'i':
+          m_typeVector.push_back (I_FRAME);
+          break;
+        case 'P':
+        case 'p':
+          m_typeVector.push_back (P_FRAME);
+          break;
+        case 'B':
+        case 'b':
+          m_typeVector.push_back (B_FRAME);
+          break;
+        default:
+          NS_FATAL_ERROR ("Invalid frame type '" << type << "' at frame " << m_sizes.size () - 1
+                          << " in " << m_fileName);
+        }
+    }
+  m_sizes.shrink_to_fit ();
+  m_frames = m_sizes.data ();
+  m_count = m_sizes.size ();
+
+  //타입이 없는 트레이스는 모든 프레임을 I 프레임으로 취급
+  if (typed)
+    {
+      m_typeVector.shrink_to_fit ();
+      m_types = m_typeVector.data ();
+    }
+  else
+    {
+      std::vector<uint8_t> ().swap (m_typeVector);
+    }
+  BuildReferences ();
+  return true;
+}
+
+//프레임 별로 직전 앵커(I 또는 P) 프레임 번호를 기록
+void
+RtspFrameTrace::BuildReferences ()
+{
+  if (m_types == 0)
+    {
+      return;
+    }
+
+  m_references.resize (m_count);
+  uint32_t anchor = 0;
+  bool hasAnchor = false;
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      if (m_types[i] == I_FRAME || !hasAnchor)
+        {
+          m_references[i] = i;
+        }
+      else
+        {
+          m_references[i] = anchor;
+        }
+      if (m_types[i] != B_FRAME)
+        {
+          anchor = i;
+          hasAnchor = true;
+        }
+    }
+}
+
+uint32_t
+RtspFrameTrace::GetFrameCount () const
+{
+  return m_count;
+}
+
+bool
+RtspFrameTrace::HasFrameTypes () const
+{
+  return m_types != 0;
+}
+
+uint64_t
+RtspFrameTrace::GetTotalBytes () const
+{
+  return m_totalBytes;
+}
+
+const std::string &
+RtspFrameTrace::GetFileName () const
+{
+  return m_fileName;
+}
+
+bool
+RtspFrameTrace::IsMapped () const
+{
+  return m_mapBase != 0;
+}
+
+}
@@ -0,0 +1,113 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+프레임 트레이스 캐시
+
+scratch/frame.txt 같은 프레임 크기 목록을 한 번만 읽어서
+모든 서버/세션이 프레임 번호로 공유해서 사용합니다.
+
+- 텍스트 형식: 한 줄에 프레임 하나, "크기 [타입]" (타입은 I, P, B)
+  타입이 하나도 없는 파일은 모든 프레임을 I 프레임(독립 디코딩)으로 취급
+  일부 줄에만 타입이 없으면 그 프레임은 P 프레임으로 취급
+- 바이너리 형식: ConvertToBinary로 변환한 파일, mmap으로 읽음
+- 두 형식 모두 I/P/B가 아닌 타입이 있으면 NS_FATAL_ERROR
+
+디코딩 참조 관계
+- I 프레임: 참조 없음, GOP의 시작
+- P 프레임: 직전 앵커(I 또는 P) 프레임을 참조
+- B 프레임: 직전 앵커 프레임을 참조, 다른 프레임이 참조하지 않음
+  (다음 앵커에 대한 참조는 표시 순서로 전송하는 이 모델에서는 생략)
+
+*/
+
+#ifndef RTSP_FRAME_TRACE_H
+#define RTSP_FRAME_TRACE_H
+
+#include <ns3/ptr.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/assert.h>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class RtspFrameTrace : public SimpleRefCount<RtspFrameTrace>
+{
+public:
+    enum FrameType_t
+    {
+        I_FRAME = 0,
+        P_FRAME = 1,
+        B_FRAME = 2,
+    };
+
+    //파일 이름별로 캐시된 트레이스 반환, 없으면 읽어서 캐시에 등록
+    //읽기에 실패하면 0 반환
+    static Ptr<RtspFrameTrace> Load (const std::string &fileName);
+    //텍스트 트레이스를 바이너리 형식으로 변환
+    static bool ConvertToBinary (const std::string &textFile, const std::string &binaryFile);
+
+    ~RtspFrameTrace ();
+
+    uint32_t GetFrameCount () const;
+    uint32_t GetFrameSize (uint32_t frame) const;
+    FrameType_t GetFrameType (uint32_t frame) const;
+    //frame이 참조하는 앵커 프레임 번호, 참조가 없으면 frame 자신
+    uint32_t GetReference (uint32_t frame) const;
+    //트레이스에 프레임 타입 정보가 있는지 여부
+    bool HasFrameTypes () const;
+    uint64_t GetTotalBytes () const;
+    const std::string &GetFileName () const;
+    bool IsMapped () const;
+
+private:
+    RtspFrameTrace (const std::string &fileName);
+
+    bool LoadBinary ();
+    bool LoadText ();
+    void BuildReferences ();
+
+    static std::map<std::string, RtspFrameTrace *> &GetCache ();
+
+    static const char MAGIC[8];             //바이너리 파일 식별자 (크기만 있는 형식)
+    static const char MAGIC_TYPED[8];       //바이너리 파일 식별자 (프레임 타입 포함)
+
+    std::string m_fileName;                 //트레이스 파일 이름
+    std::vector<uint32_t> m_sizes;          //텍스트에서 읽은 프레임 크기
+    const uint32_t *m_frames;               //프레임 크기 배열 (m_sizes 또는 mmap 영역)
+    std::vector<uint8_t> m_typeVector;      //텍스트에서 읽은 프레임 타입
+    const uint8_t *m_types;                 //프레임 타입 배열, 타입 정보가 없으면 0
+    std::vector<uint32_t> m_references;     //프레임 별 참조 앵커 프레임 번호
+    uint32_t m_count;                       //프레임 개수
+    uint64_t m_totalBytes;                  //전체 프레임 크기 합
+
+    void *m_mapBase;                        //mmap 시작 주소
+    size_t m_mapLength;                     //mmap 길이
+};
+
+inline uint32_t
+RtspFrameTrace::GetFrameSize (uint32_t frame) const
+{
+  NS_ASSERT (frame < m_count);
+  return m_frames[frame];
+}
+
+inline RtspFrameTrace::FrameType_t
+RtspFrameTrace::GetFrameType (uint32_t frame) const
+{
+  NS_ASSERT (frame < m_count);
+  return m_types != 0 ? (FrameType_t) m_types[frame] : I_FRAME;
+}
+
+inline uint32_t
+RtspFrameTrace::GetReference (uint32_t frame) const
+{
+  NS_ASSERT (frame < m_count);
+  return m_types != 0 ? m_references[frame] : frame;
+}
+
+}
+
+#endif
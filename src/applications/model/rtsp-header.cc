@@ -0,0 +1,332 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-header.h"
+
+#include <ns3/log.h>
+#include <ns3/unused.h>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("RtspHeader");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RtspHeader);
+
+const uint32_t RtspHeader::MAX_URL_SIZE;
+
+RtspHeader::RtspHeader ()
+  : m_method (SETUP),
+    m_status (REQUEST),
+    m_cseq (0),
+    m_session (0),
+    m_transportFlags (0),
+    m_destination (Ipv4Address::GetAny ()),
+    m_clientRtpPort (0),
+    m_clientRtcpPort (0),
+    m_framePeriod (0),
+    m_frameCount (0),
+    m_urlLength (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspHeader::SetMethod (Method_t method)
+{
+  m_method = method;
+}
+
+RtspHeader::Method_t
+RtspHeader::GetMethod (void) const
+{
+  return m_method;
+}
+
+void
+RtspHeader::SetStatus (uint16_t status)
+{
+  m_status = status;
+}
+
+uint16_t
+RtspHeader::GetStatus (void) const
+{
+  return m_status;
+}
+
+bool
+RtspHeader::IsResponse (void) const
+{
+  return m_status != REQUEST;
+}
+
+void
+RtspHeader::SetCSeq (uint32_t cseq)
+{
+  m_cseq = cseq;
+}
+
+uint32_t
+RtspHeader::GetCSeq (void) const
+{
+  return m_cseq;
+}
+
+void
+RtspHeader::SetSession (uint32_t session)
+{
+  m_session = session;
+}
+
+uint32_t
+RtspHeader::GetSession (void) const
+{
+  return m_session;
+}
+
+void
+RtspHeader::SetClientPorts (uint16_t rtpPort, uint16_t rtcpPort)
+{
+  m_clientRtpPort = rtpPort;
+  m_clientRtcpPort = rtcpPort;
+}
+
+uint16_t
+RtspHeader::GetClientRtpPort (void) const
+{
+  return m_clientRtpPort;
+}
+
+uint16_t
+RtspHeader::GetClientRtcpPort (void) const
+{
+  return m_clientRtcpPort;
+}
+
+void
+RtspHeader::SetMulticast (bool multicast)
+{
+  if (multicast)
+    {
+      m_transportFlags |= FLAG_MULTICAST;
+    }
+  else
+    {
+      m_transportFlags &= ~FLAG_MULTICAST;
+    }
+}
+
+bool
+RtspHeader::IsMulticast (void) const
+{
+  return (m_transportFlags & FLAG_MULTICAST) != 0;
+}
+
+void
+RtspHeader::SetNack (bool nack)
+{
+  if (nack)
+    {
+      m_transportFlags |= FLAG_NACK;
+    }
+  else
+    {
+      m_transportFlags &= ~FLAG_NACK;
+    }
+}
+
+bool
+RtspHeader::IsNack (void) const
+{
+  return (m_transportFlags & FLAG_NACK) != 0;
+}
+
+void
+RtspHeader::SetDestination (Ipv4Address destination)
+{
+  m_destination = destination;
+}
+
+Ipv4Address
+RtspHeader::GetDestination (void) const
+{
+  return m_destination;
+}
+
+void
+RtspHeader::SetFramePeriod (uint32_t framePeriod)
+{
+  m_framePeriod = framePeriod;
+}
+
+uint32_t
+RtspHeader::GetFramePeriod (void) const
+{
+  return m_framePeriod;
+}
+
+void
+RtspHeader::SetFrameCount (uint32_t frameCount)
+{
+  m_frameCount = frameCount;
+}
+
+uint32_t
+RtspHeader::GetFrameCount (void) const
+{
+  return m_frameCount;
+}
+
+void
+RtspHeader::SetUrl (const std::string &url)
+{
+  if (url.size () > MAX_URL_SIZE)
+    {
+      NS_FATAL_ERROR ("RTSP url longer than " << MAX_URL_SIZE << " bytes: " << url);
+    }
+  m_urlLength = url.size ();
+  std::copy (url.begin (), url.end (), m_url);
+}
+
+std::string
+RtspHeader::GetUrl (void) const
+{
+  return std::string (m_url, m_urlLength);
+}
+
+const char *
+RtspHeader::MethodToString (Method_t method)
+{
+  switch (method)
+    {
+    case SETUP:
+      return "SETUP";
+    case PLAY:
+      return "PLAY";
+    case PAUSE:
+      return "PAUSE";
+    case TEARDOWN:
+      return "TEARDOWN";
+    case MODIFY:
+      return "MODIFY";
+    }
+  return "UNKNOWN";
+}
+
+uint32_t
+RtspHeader::PeekMessageSize (Ptr<const Packet> buffer)
+{
+  if (buffer->GetSize () < 2)
+    {
+      return 0;
+    }
+  uint8_t length[2];
+  buffer->CopyData (length, 2);
+  return (length[0] << 8) | length[1];
+}
+
+TypeId
+RtspHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtspHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+RtspHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(" << MethodToString (m_method);
+  if (IsResponse ())
+    {
+      os << " status=" << m_status;
+    }
+  os << " CSeq=" << m_cseq << " Session=" << m_session
+     << " Transport=" << m_clientRtpPort << "-" << m_clientRtcpPort;
+  if (IsMulticast ())
+    {
+      os << " multicast destination=" << m_destination;
+    }
+  if (IsNack ())
+    {
+      os << " nack";
+    }
+  if (m_framePeriod != 0)
+    {
+      os << " period=" << m_framePeriod;
+    }
+  if (m_frameCount != 0)
+    {
+      os << " frames=" << m_frameCount;
+    }
+  if (m_urlLength != 0)
+    {
+      os << " url=";
+      os.write (m_url, m_urlLength);
+    }
+  os << ")";
+}
+
+uint32_t
+RtspHeader::GetSerializedSize (void) const
+{
+  return FIXED_SIZE + m_urlLength;
+}
+
+void
+RtspHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU16 (GetSerializedSize ());
+  i.WriteU8 (m_method);
+  i.WriteHtonU16 (m_status);
+  i.WriteHtonU32 (m_cseq);
+  i.WriteHtonU32 (m_session);
+  i.WriteU8 (m_transportFlags);
+  i.WriteHtonU32 (m_destination.Get ());
+  i.WriteHtonU16 (m_clientRtpPort);
+  i.WriteHtonU16 (m_clientRtcpPort);
+  i.WriteHtonU32 (m_framePeriod);
+  i.WriteHtonU32 (m_frameCount);
+  i.WriteHtonU16 (m_urlLength);
+  i.Write ((const uint8_t *) m_url, m_urlLength);
+}
+
+uint32_t
+RtspHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint16_t length = i.ReadNtohU16 ();
+  m_method = (Method_t) i.ReadU8 ();
+  m_status = i.ReadNtohU16 ();
+  m_cseq = i.ReadNtohU32 ();
+  m_session = i.ReadNtohU32 ();
+  m_transportFlags = i.ReadU8 ();
+  m_destination.Set (i.ReadNtohU32 ());
+  m_clientRtpPort = i.ReadNtohU16 ();
+  m_clientRtcpPort = i.ReadNtohU16 ();
+  m_framePeriod = i.ReadNtohU32 ();
+  m_frameCount = i.ReadNtohU32 ();
+  m_urlLength = i.ReadNtohU16 ();
+  if (m_urlLength > MAX_URL_SIZE)
+    {
+      NS_FATAL_ERROR ("Malformed RTSP header: url length " << m_urlLength);
+    }
+  i.Read ((uint8_t *) m_url, m_urlLength);
+  NS_ASSERT_MSG (length == GetSerializedSize (), "Malformed RTSP header");
+  NS_UNUSED (length);
+  return GetSerializedSize ();
+}
+
+}
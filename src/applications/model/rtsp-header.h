@@ -0,0 +1,117 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 제어 메시지 헤더
+
+요청과 응답을 모두 이 헤더 하나로 주고받습니다.
+TCP 스트림에서 메시지 경계를 찾을 수 있도록 맨 앞에 전체 길이를 기록합니다.
+
+length(2) | method(1) | status(2) | CSeq(4) | Session(4)
+| Transport: flags(1), destination(4), client RTP port(2), client RTCP port(2) | frame period(4)
+| frame count(4) | url length(2) | url
+
+Transport flags의 multicast 비트는 요청에서는 multicast 전송을 원한다는 뜻이고,
+응답에서는 서버가 destination(multicast 그룹):RTP port로 보낸다는 뜻입니다.
+nack 비트는 요청에서는 클라이언트가 RTCP NACK을 보낸다는 뜻이고,
+응답에서는 서버가 처음 보내는 패킷부터 재전송용으로 보관한다는 뜻입니다.
+
+url은 메시지마다 힙 할당이 생기지 않도록 고정 크기 버퍼(MAX_URL_SIZE)에 보관하며,
+SETUP 요청에만 붙습니다. GetUrl은 호출할 때 std::string을 만듭니다.
+
+*/
+
+#ifndef RTSP_HEADER_H
+#define RTSP_HEADER_H
+
+#include <ns3/header.h>
+#include <ns3/packet.h>
+#include <ns3/ipv4-address.h>
+#include <string>
+
+namespace ns3 {
+
+class RtspHeader : public Header
+{
+public:
+  enum Method_t
+  {
+    SETUP,
+    PLAY,
+    PAUSE,
+    TEARDOWN,
+    MODIFY,
+  };
+
+  enum Status_t
+  {
+    REQUEST = 0,                //요청 메시지
+    OK = 200,
+    BAD_REQUEST = 400,
+    NOT_FOUND = 404,
+    SESSION_NOT_FOUND = 454,
+  };
+
+  RtspHeader ();
+
+  void SetMethod (Method_t method);
+  Method_t GetMethod (void) const;
+  void SetStatus (uint16_t status);
+  uint16_t GetStatus (void) const;
+  bool IsResponse (void) const;
+  void SetCSeq (uint32_t cseq);
+  uint32_t GetCSeq (void) const;
+  void SetSession (uint32_t session);
+  uint32_t GetSession (void) const;
+  void SetClientPorts (uint16_t rtpPort, uint16_t rtcpPort);
+  uint16_t GetClientRtpPort (void) const;
+  uint16_t GetClientRtcpPort (void) const;
+  void SetMulticast (bool multicast);
+  bool IsMulticast (void) const;
+  void SetNack (bool nack);
+  bool IsNack (void) const;
+  void SetDestination (Ipv4Address destination);
+  Ipv4Address GetDestination (void) const;
+  void SetFramePeriod (uint32_t framePeriod);
+  uint32_t GetFramePeriod (void) const;
+  void SetFrameCount (uint32_t frameCount);
+  uint32_t GetFrameCount (void) const;
+  void SetUrl (const std::string &url);
+  std::string GetUrl (void) const;
+
+  const static uint32_t MAX_URL_SIZE = 256;
+
+  static const char *MethodToString (Method_t method);
+
+  //버퍼 맨 앞 메시지의 전체 길이, 길이를 읽을 수 없으면 0
+  static uint32_t PeekMessageSize (Ptr<const Packet> buffer);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  const static uint32_t FIXED_SIZE = 2 + 1 + 2 + 4 + 4 + 1 + 4 + 2 + 2 + 4 + 4 + 2;
+  const static uint8_t FLAG_MULTICAST = 0x01;
+  const static uint8_t FLAG_NACK = 0x02;
+
+  Method_t m_method;          //RTSP 메소드
+  uint16_t m_status;          //응답 코드, 요청이면 0
+  uint32_t m_cseq;            //CSeq
+  uint32_t m_session;         //Session ID, 없으면 0
+  uint8_t m_transportFlags;   //Transport: multicast, NACK 여부
+  Ipv4Address m_destination;  //Transport: multicast 그룹 주소
+  uint16_t m_clientRtpPort;   //Transport: 클라이언트 RTP 포트
+  uint16_t m_clientRtcpPort;  //Transport: 클라이언트 RTCP 포트
+  uint32_t m_framePeriod;     //프레임 간격 (ms), SETUP 응답에서 사용
+  uint32_t m_frameCount;      //스트림의 프레임 수, SETUP 응답에서 사용 (모르면 0)
+  uint16_t m_urlLength;       //url 길이, url이 없으면 0
+  char m_url[MAX_URL_SIZE];   //요청 대상 (트레이스 파일 이름), SETUP 요청에서 사용
+};
+
+}
+
+#endif
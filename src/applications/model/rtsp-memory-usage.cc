@@ -0,0 +1,50 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-memory-usage.h"
+
+namespace ns3 {
+
+RtspMemoryUsage::RtspMemoryUsage ()
+  : jitterBuffer (0),
+    sendHistory (0),
+    paceQueue (0),
+    fec (0),
+    control (0)
+{
+}
+
+uint64_t
+RtspMemoryUsage::GetTotal (void) const
+{
+  return jitterBuffer + sendHistory + paceQueue + fec + control;
+}
+
+RtspMemoryUsage &
+RtspMemoryUsage::operator += (const RtspMemoryUsage &other)
+{
+  jitterBuffer += other.jitterBuffer;
+  sendHistory += other.sendHistory;
+  paceQueue += other.paceQueue;
+  fec += other.fec;
+  control += other.control;
+  return *this;
+}
+
+void
+RtspMemoryUsage::Print (std::ostream &os) const
+{
+  os << "total=" << GetTotal ()
+     << " jitterBuffer=" << jitterBuffer
+     << " sendHistory=" << sendHistory
+     << " paceQueue=" << paceQueue
+     << " fec=" << fec
+     << " control=" << control;
+}
+
+std::ostream &
+operator << (std::ostream &os, const RtspMemoryUsage &usage)
+{
+  usage.Print (os);
+  return os;
+}
+
+}
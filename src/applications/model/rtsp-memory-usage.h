@@ -0,0 +1,50 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 세션 메모리 사용량
+
+세션 하나(또는 여러 세션의 합)가 보관 중인 바이트를 항목별로 나타냅니다.
+RtspServer::GetSessionMemoryUsage / GetMemoryUsage, RtspClient::GetMemoryUsage가 반환합니다.
+
+- jitterBuffer : 클라이언트 지터 버퍼 슬롯 배열 (프레임 메타데이터만 보관, 페이로드는 저장하지 않음)
+- sendHistory  : 서버 재전송용 send history (슬롯 배열 + 보관 중인 RTP 패킷)
+- paceQueue    : 서버 pacing 대기 중인 RTP 패킷
+- fec          : FEC 묶음/복원 윈도우
+- control      : 세션 구조체, RTSP 수신 버퍼, NACK 대기 목록
+
+패킷은 GetSize() 기준이고 컨테이너는 원소 크기 * 개수로 계산한 근사값입니다.
+(할당자 오버헤드는 포함하지 않음)
+
+*/
+
+#ifndef RTSP_MEMORY_USAGE_H
+#define RTSP_MEMORY_USAGE_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace ns3 {
+
+class RtspMemoryUsage
+{
+public:
+  RtspMemoryUsage ();
+
+  uint64_t GetTotal (void) const;
+  RtspMemoryUsage &operator += (const RtspMemoryUsage &other);
+
+  void Print (std::ostream &os) const;
+
+  uint64_t jitterBuffer;        //지터 버퍼
+  uint64_t sendHistory;         //재전송용 send history
+  uint64_t paceQueue;           //pacing 대기 패킷
+  uint64_t fec;                 //FEC 상태
+  uint64_t control;             //세션 구조체와 제어용 버퍼
+};
+
+std::ostream &operator << (std::ostream &os, const RtspMemoryUsage &usage);
+
+}
+
+#endif
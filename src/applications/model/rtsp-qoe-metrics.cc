@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-qoe-metrics.h"
+
+#include <ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE("RtspQoeMetrics");
+
+namespace ns3 {
+
+RtspQoeMetrics::RtspQoeMetrics ()
+{
+  Reset ();
+}
+
+void
+RtspQoeMetrics::Reset (void)
+{
+  m_playRequest = Time (0);
+  m_playRequested = false;
+  m_started = false;
+  m_startupDelay = Time (0);
+  m_stalled = false;
+  m_stallStart = Time (0);
+  m_stallCount = 0;
+  m_stallDuration = Time (0);
+  m_playDuration = Time (0);
+  m_playedBytes = 0;
+  m_representation = 0;
+  m_qualitySwitches = 0;
+}
+
+void
+RtspQoeMetrics::NotifyPlayRequest (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  //startup delay는 처음 PLAY부터만 잼, PAUSE 후 다시 PLAY는 제외
+  if (!m_playRequested)
+    {
+      m_playRequest = now;
+      m_playRequested = true;
+    }
+}
+
+Time
+RtspQoeMetrics::NotifyFramePlayed (Time now, Time framePeriod, uint32_t bytes, uint32_t representation)
+{
+  NS_LOG_FUNCTION (this << now << framePeriod << bytes << representation);
+
+  Time stall = Time (0);
+  if (!m_started)
+    {
+      m_started = true;
+      m_startupDelay = m_playRequested ? now - m_playRequest : Time (0);
+      m_representation = representation;
+      NS_LOG_INFO ("Startup delay " << m_startupDelay.GetSeconds () << "s");
+    }
+  else if (representation != m_representation)
+    {
+      m_qualitySwitches++;
+      m_representation = representation;
+    }
+
+  if (m_stalled)
+    {
+      stall = now - m_stallStart;
+      m_stallDuration += stall;
+      m_stalled = false;
+      NS_LOG_INFO ("Stall ended after " << stall.GetSeconds () << "s");
+    }
+
+  m_playDuration += framePeriod;
+  m_playedBytes += bytes;
+  return stall;
+}
+
+bool
+RtspQoeMetrics::NotifyFrameMissing (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  //첫 프레임 이전의 버퍼링은 startup delay에 포함
+  if (!m_started || m_stalled)
+    {
+      return false;
+    }
+  m_stalled = true;
+  m_stallStart = now;
+  m_stallCount++;
+  return true;
+}
+
+Time
+RtspQoeMetrics::NotifyStop (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  if (!m_stalled)
+    {
+      return Time (0);
+    }
+  Time stall = now - m_stallStart;
+  m_stallDuration += stall;
+  m_stalled = false;
+  return stall;
+}
+
+bool
+RtspQoeMetrics::HasStarted (void) const
+{
+  return m_started;
+}
+
+bool
+RtspQoeMetrics::IsStalled (void) const
+{
+  return m_stalled;
+}
+
+Time
+RtspQoeMetrics::GetStartupDelay (void) const
+{
+  return m_startupDelay;
+}
+
+uint32_t
+RtspQoeMetrics::GetStallCount (void) const
+{
+  return m_stallCount;
+}
+
+Time
+RtspQoeMetrics::GetStallDuration (void) const
+{
+  return m_stallDuration;
+}
+
+Time
+RtspQoeMetrics::GetPlayDuration (void) const
+{
+  return m_playDuration;
+}
+
+double
+RtspQoeMetrics::GetRebufferRatio (void) const
+{
+  double total = m_playDuration.GetSeconds () + m_stallDuration.GetSeconds ();
+  return total > 0 ? m_stallDuration.GetSeconds () / total : 0;
+}
+
+double
+RtspQoeMetrics::GetAverageBitrate (void) const
+{
+  double seconds = m_playDuration.GetSeconds ();
+  return seconds > 0 ? m_playedBytes * 8 / seconds : 0;
+}
+
+uint32_t
+RtspQoeMetrics::GetQualitySwitches (void) const
+{
+  return m_qualitySwitches;
+}
+
+uint32_t
+RtspQoeMetrics::GetRepresentation (void) const
+{
+  return m_representation;
+}
+
+void
+RtspQoeMetrics::Print (std::ostream &os) const
+{
+  os << "startup=" << m_startupDelay.GetSeconds () << "s"
+     << " stalls=" << m_stallCount
+     << " stallTime=" << m_stallDuration.GetSeconds () << "s"
+     << " playTime=" << m_playDuration.GetSeconds () << "s"
+     << " rebufferRatio=" << GetRebufferRatio ()
+     << " bitrate=" << GetAverageBitrate () << "bps"
+     << " switches=" << m_qualitySwitches;
+}
+
+std::ostream &
+operator << (std::ostream &os, const RtspQoeMetrics &metrics)
+{
+  metrics.Print (os);
+  return os;
+}
+
+}
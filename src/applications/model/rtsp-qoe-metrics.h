@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 수신 QoE 지표
+
+RtspClient가 재생 시점마다 프레임 재생/부재를 알려주면 아래 지표를 누적합니다.
+
+- startup delay   : PLAY 요청부터 첫 프레임 재생까지 걸린 시간
+- stall           : 첫 프레임 재생 이후 재생 시점에 프레임이 없었던 구간
+                    프레임이 다시 재생되면(또는 PAUSE, 종료 시) 하나의 stall이 끝남
+- rebuffer ratio  : stall 시간 / (재생 시간 + stall 시간)
+- 평균 비트레이트 : 디코딩된 프레임 바이트 * 8 / 재생 시간
+- quality switch  : 연속으로 재생된 두 프레임의 representation이 다른 횟수
+
+재생 시간은 재생된 프레임 수 * 프레임 주기로 계산하므로 PAUSE 구간은 포함되지 않습니다.
+
+*/
+
+#ifndef RTSP_QOE_METRICS_H
+#define RTSP_QOE_METRICS_H
+
+#include <ns3/nstime.h>
+#include <ostream>
+
+namespace ns3 {
+
+class RtspQoeMetrics
+{
+public:
+  RtspQoeMetrics ();
+
+  void Reset (void);
+
+  //PLAY 요청, 첫 프레임이 재생되기 전이면 startup delay 측정 시작
+  void NotifyPlayRequest (Time now);
+  //재생 시점에 프레임 재생, 끝난 stall이 있으면 그 길이를 반환 (없으면 0)
+  //bytes는 디코딩된 프레임만 넘기고, 디코딩하지 못한 프레임은 0
+  Time NotifyFramePlayed (Time now, Time framePeriod, uint32_t bytes, uint32_t representation);
+  //재생 시점에 프레임이 없음, 새 stall이 시작되면 true
+  bool NotifyFrameMissing (Time now);
+  //PAUSE나 종료로 재생이 멈춤, 진행 중인 stall이 있으면 끝내고 그 길이를 반환
+  Time NotifyStop (Time now);
+
+  bool HasStarted (void) const;
+  bool IsStalled (void) const;
+  Time GetStartupDelay (void) const;
+  uint32_t GetStallCount (void) const;
+  Time GetStallDuration (void) const;
+  Time GetPlayDuration (void) const;
+  double GetRebufferRatio (void) const;
+  //평균 재생 비트레이트 (bps)
+  double GetAverageBitrate (void) const;
+  uint32_t GetQualitySwitches (void) const;
+  //마지막으로 재생된 프레임의 representation
+  uint32_t GetRepresentation (void) const;
+
+  void Print (std::ostream &os) const;
+
+private:
+  Time m_playRequest;           //첫 PLAY 요청 시각
+  bool m_playRequested;         //PLAY 요청을 보냈는지 여부
+  bool m_started;               //첫 프레임을 재생했는지 여부
+  Time m_startupDelay;          //PLAY 요청부터 첫 프레임 재생까지
+
+  bool m_stalled;               //stall 진행 중 여부
+  Time m_stallStart;            //진행 중인 stall의 시작 시각
+  uint32_t m_stallCount;        //stall 횟수
+  Time m_stallDuration;         //끝난 stall의 총 길이
+
+  Time m_playDuration;          //재생된 프레임 수 * 프레임 주기
+  uint64_t m_playedBytes;       //디코딩되어 재생된 바이트
+  uint32_t m_representation;    //마지막으로 재생된 프레임의 representation
+  uint32_t m_qualitySwitches;   //representation 변경 횟수
+};
+
+std::ostream &operator << (std::ostream &os, const RtspQoeMetrics &metrics);
+
+}
+
+#endif
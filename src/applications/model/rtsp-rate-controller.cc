@@ -0,0 +1,406 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-rate-controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+
+NS_LOG_COMPONENT_DEFINE("RtspRateController");
+
+namespace ns3 {
+
+/**************************************************
+*               RtspRateController
+***************************************************/
+NS_OBJECT_ENSURE_REGISTERED(RtspRateController);
+
+TypeId
+RtspRateController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspRateController")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddAttribute ("MinRateFraction",
+                   "Lowest target rate as a fraction of the trace bitrate.",
+                   DoubleValue (1.0 / 16),
+                   MakeDoubleAccessor (&RtspRateController::m_minRateFraction),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+RtspRateController::RtspRateController ()
+  : m_maxRate (0),
+    m_minRateFraction (1.0 / 16),
+    m_targetRate (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RtspRateController::~RtspRateController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspRateController::Reset (double maxRate)
+{
+  NS_LOG_FUNCTION (this << maxRate);
+  m_maxRate = maxRate;
+  m_targetRate = GetMinRate ();
+}
+
+double
+RtspRateController::GetTargetRate (void) const
+{
+  return m_targetRate;
+}
+
+double
+RtspRateController::GetMaxRate (void) const
+{
+  return m_maxRate;
+}
+
+double
+RtspRateController::GetMinRate (void) const
+{
+  return m_maxRate * m_minRateFraction;
+}
+
+void
+RtspRateController::SetTargetRate (double rate)
+{
+  m_targetRate = std::min (std::max (rate, GetMinRate ()), m_maxRate);
+}
+
+/**************************************************
+*             RtspLevelRateController
+***************************************************/
+NS_OBJECT_ENSURE_REGISTERED(RtspLevelRateController);
+
+TypeId
+RtspLevelRateController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspLevelRateController")
+    .SetParent<RtspRateController> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspLevelRateController> ()
+    .AddAttribute ("UseCongestionThreshold",
+                   "Enable or Disable congestion threshold.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RtspLevelRateController::m_useCongestionThreshold),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+RtspLevelRateController::RtspLevelRateController ()
+{
+  NS_LOG_FUNCTION (this);
+  m_congestionLevel = MAX_CONGESTION_LEVEL;
+  m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
+  m_useCongestionThreshold = true;
+  m_upscale = 0;
+  m_fractionLost = 0;
+}
+
+void
+RtspLevelRateController::Reset (double maxRate)
+{
+  NS_LOG_FUNCTION (this << maxRate);
+  RtspRateController::Reset (maxRate);
+  m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
+  m_upscale = 0;
+  m_fractionLost = 0;
+  SetLevel (MAX_CONGESTION_LEVEL);
+}
+
+void
+RtspLevelRateController::SetLevel (double level)
+{
+  m_congestionLevel = level;
+  SetTargetRate (m_maxRate / level);
+}
+
+void
+RtspLevelRateController::OnReport (const RtspRateFeedback &feedback)
+{
+  NS_LOG_FUNCTION (this);
+
+  //보고 구간의 loss 비율을 평활화해서 사용
+  double fractionLost = feedback.fractionLost * 0.85 + m_fractionLost * 0.15;
+  m_fractionLost = fractionLost;
+
+  if(fractionLost >= 0 && fractionLost <= 0.05)
+  {
+    if(
+      m_upscale == int(MAX_CONGESTION_LEVEL + 2 - m_congestionLevel)
+      && m_congestionLevel > MIN_CONGESTION_LEVEL
+      && ( 
+          !m_useCongestionThreshold || 
+          (m_congestionThreshold > MAX_CONGESTION_LEVEL || m_congestionLevel > m_congestionThreshold)
+      )
+    ) 
+    {
+      SetLevel (m_congestionLevel / 2);
+      m_upscale = 0;
+    }
+    else m_upscale++;
+  }
+  else if(fractionLost > 0.2) 
+  {
+    if(m_congestionLevel < MAX_CONGESTION_LEVEL) {
+      SetLevel (m_congestionLevel * 2);
+    }
+    if(m_congestionThreshold > m_congestionLevel) {
+      m_congestionThreshold = m_congestionLevel;
+    }
+    m_upscale = 0;
+  }
+  NS_LOG_INFO ("FractionLost " << fractionLost << " with congestion " << m_congestionLevel);
+}
+
+void
+RtspLevelRateController::OnModify (void)
+{
+  NS_LOG_FUNCTION (this);
+  if(m_congestionLevel > MIN_CONGESTION_LEVEL)
+  {
+    SetLevel (m_congestionLevel / 2);
+    m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
+  }
+}
+
+/**************************************************
+*              RtspGccRateController
+***************************************************/
+NS_OBJECT_ENSURE_REGISTERED(RtspGccRateController);
+
+TypeId
+RtspGccRateController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspGccRateController")
+    .SetParent<RtspRateController> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspGccRateController> ()
+    .AddAttribute ("StartRateFraction",
+                   "Initial target rate as a fraction of the trace bitrate.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&RtspGccRateController::m_startRateFraction),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Beta",
+                   "Rate multiplier applied when the delay gradient signals overuse.",
+                   DoubleValue (0.85),
+                   MakeDoubleAccessor (&RtspGccRateController::m_beta),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("IncreaseFactor",
+                   "Multiplicative rate increase per second while the path is not overused.",
+                   DoubleValue (1.08),
+                   MakeDoubleAccessor (&RtspGccRateController::m_increaseFactor),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("ThresholdGainUp",
+                   "Adaptation gain of the overuse threshold when the gradient exceeds it (per ms).",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&RtspGccRateController::m_gainUp),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ThresholdGainDown",
+                   "Adaptation gain of the overuse threshold when the gradient is below it (per ms).",
+                   DoubleValue (0.00018),
+                   MakeDoubleAccessor (&RtspGccRateController::m_gainDown),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Smoothing",
+                   "Weight of the previous delay gradient in the exponential filter.",
+                   DoubleValue (0.6),
+                   MakeDoubleAccessor (&RtspGccRateController::m_smoothing),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+RtspGccRateController::RtspGccRateController ()
+  : m_startRateFraction (0.25),
+    m_beta (0.85),
+    m_increaseFactor (1.08),
+    m_gainUp (0.01),
+    m_gainDown (0.00018),
+    m_smoothing (0.6),
+    m_delayRate (0),
+    m_lossRate (0),
+    m_gradient (0),
+    m_threshold (12.5),
+    m_hold (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspGccRateController::Reset (double maxRate)
+{
+  NS_LOG_FUNCTION (this << maxRate);
+  RtspRateController::Reset (maxRate);
+  SetTargetRate (maxRate * m_startRateFraction);
+  m_delayRate = m_targetRate;
+  m_lossRate = m_targetRate;
+  m_gradient = 0;
+  m_threshold = 12.5;
+  m_lastDelay = Time (0);
+  m_lastReport = Time (0);
+  m_hold = false;
+}
+
+//one-way delay 기울기를 적응형 threshold와 비교
+RtspGccRateController::Signal_t
+RtspGccRateController::Detect (const RtspRateFeedback &feedback)
+{
+  if (feedback.oneWayDelay.IsZero ())
+    {
+      return NORMAL;
+    }
+  if (m_lastDelay.IsZero ())
+    {
+      m_lastDelay = feedback.oneWayDelay;
+      return NORMAL;
+    }
+
+  double delta = (feedback.oneWayDelay - m_lastDelay).GetSeconds () * 1000;
+  m_lastDelay = feedback.oneWayDelay;
+  m_gradient = m_smoothing * m_gradient + (1 - m_smoothing) * delta;
+
+  //threshold 적응 (draft-ietf-rmcat-gcc 5.4)
+  double interval = (feedback.now - m_lastReport).GetSeconds () * 1000;
+  double gain = std::fabs (m_gradient) < m_threshold ? m_gainDown : m_gainUp;
+  m_threshold += std::min (interval, 100.0) * gain * (std::fabs (m_gradient) - m_threshold);
+  m_threshold = std::min (std::max (m_threshold, 6.0), 600.0);
+
+  if (m_gradient > m_threshold)
+    {
+      return OVERUSE;
+    }
+  if (m_gradient < -m_threshold)
+    {
+      return UNDERUSE;
+    }
+  return NORMAL;
+}
+
+void
+RtspGccRateController::OnReport (const RtspRateFeedback &feedback)
+{
+  NS_LOG_FUNCTION (this);
+
+  Signal_t signal = Detect (feedback);
+  double elapsed = m_lastReport.IsZero () ? 0 : (feedback.now - m_lastReport).GetSeconds ();
+  m_lastReport = feedback.now;
+
+  //delay 기반 제어
+  if (signal == OVERUSE)
+    {
+      m_delayRate = m_beta * std::min (m_delayRate, m_targetRate);
+      m_hold = false;
+    }
+  else if (signal == UNDERUSE)
+    {
+      //큐가 비워지는 동안은 유지
+      m_hold = true;
+    }
+  else if (m_hold)
+    {
+      m_hold = false;
+    }
+  else
+    {
+      m_delayRate *= std::pow (m_increaseFactor, elapsed);
+    }
+
+  //loss 기반 제어
+  if (feedback.fractionLost > 0.1)
+    {
+      m_lossRate *= 1 - 0.5 * feedback.fractionLost;
+    }
+  else if (feedback.fractionLost < 0.02)
+    {
+      m_lossRate *= 1.05;
+    }
+
+  m_delayRate = std::min (std::max (m_delayRate, GetMinRate ()), m_maxRate);
+  m_lossRate = std::min (std::max (m_lossRate, GetMinRate ()), m_maxRate);
+  SetTargetRate (std::min (m_delayRate, m_lossRate));
+
+  NS_LOG_INFO ("Gcc signal " << signal << " gradient " << m_gradient << "ms threshold " << m_threshold
+               << "ms loss " << feedback.fractionLost << " rate " << m_targetRate);
+}
+
+void
+RtspGccRateController::OnModify (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_delayRate = std::min (m_targetRate * 2, m_maxRate);
+  m_lossRate = m_delayRate;
+  SetTargetRate (m_delayRate);
+}
+
+/**************************************************
+*              RtspAimdRateController
+***************************************************/
+NS_OBJECT_ENSURE_REGISTERED(RtspAimdRateController);
+
+TypeId
+RtspAimdRateController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspAimdRateController")
+    .SetParent<RtspRateController> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspAimdRateController> ()
+    .AddAttribute ("AdditiveIncrease",
+                   "Rate increase per loss-free receiver report (bps).",
+                   DoubleValue (250000),
+                   MakeDoubleAccessor (&RtspAimdRateController::m_additiveIncrease),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DecreaseFactor",
+                   "Rate multiplier applied when the reported loss exceeds LossThreshold.",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&RtspAimdRateController::m_decreaseFactor),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("LossThreshold",
+                   "Reported fraction lost above which the rate is decreased.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&RtspAimdRateController::m_lossThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+RtspAimdRateController::RtspAimdRateController ()
+  : m_additiveIncrease (250000),
+    m_decreaseFactor (0.7),
+    m_lossThreshold (0.05)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspAimdRateController::OnReport (const RtspRateFeedback &feedback)
+{
+  NS_LOG_FUNCTION (this);
+  if (feedback.fractionLost > m_lossThreshold)
+    {
+      SetTargetRate (m_targetRate * m_decreaseFactor);
+    }
+  else
+    {
+      SetTargetRate (m_targetRate + m_additiveIncrease);
+    }
+  NS_LOG_INFO ("Aimd loss " << feedback.fractionLost << " rate " << m_targetRate);
+}
+
+void
+RtspAimdRateController::OnModify (void)
+{
+  NS_LOG_FUNCTION (this);
+  SetTargetRate (m_targetRate + m_additiveIncrease);
+}
+
+}
@@ -0,0 +1,138 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 전송률 제어
+
+RtspServer는 세션마다 RtspRateController를 하나씩 만들고
+RTCP 보고가 올 때마다 OnReport를 호출합니다.
+컨트롤러는 목표 비트레이트를 정하고, 서버는 원본 트레이스의 비트레이트 대비
+목표 비트레이트 비율만큼 프레임 크기를 줄여서 전송합니다.
+
+- RtspLevelRateController : 기존 방식, congestion level(1~16)을 2배씩 조절
+- RtspGccRateController   : GCC 방식, one-way delay 기울기 + loss 기반
+- RtspAimdRateController  : loss 기반 AIMD
+
+*/
+
+#ifndef RTSP_RATE_CONTROLLER_H
+#define RTSP_RATE_CONTROLLER_H
+
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+
+namespace ns3 {
+
+//RTCP 보고에서 얻은 피드백
+struct RtspRateFeedback
+{
+  double fractionLost;        //보고 구간의 loss 비율
+  Time rtt;                   //RTT, 모르면 0
+  Time jitter;                //interarrival jitter
+  Time oneWayDelay;           //보고 구간의 평균 one-way delay, 모르면 0
+  Time now;                   //보고를 받은 시각
+};
+
+class RtspRateController : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspRateController ();
+  virtual ~RtspRateController ();
+
+  //세션 시작 시 원본 트레이스 비트레이트(bps)로 초기화, 최소 비트레이트에서 시작
+  virtual void Reset (double maxRate);
+  //RTCP 보고마다 호출
+  virtual void OnReport (const RtspRateFeedback &feedback) = 0;
+  //MODIFY 요청, 품질을 한 단계 올림
+  virtual void OnModify (void) = 0;
+
+  double GetTargetRate (void) const;
+  double GetMaxRate (void) const;
+  double GetMinRate (void) const;
+
+protected:
+  //목표 비트레이트를 [최소, 최대] 범위로 제한해서 설정
+  void SetTargetRate (double rate);
+
+  double m_maxRate;           //원본 트레이스 비트레이트
+  double m_minRateFraction;   //최대 대비 최소 비트레이트 비율
+  double m_targetRate;        //현재 목표 비트레이트
+};
+
+class RtspLevelRateController : public RtspRateController
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspLevelRateController ();
+
+  virtual void Reset (double maxRate);
+  virtual void OnReport (const RtspRateFeedback &feedback);
+  virtual void OnModify (void);
+
+private:
+  void SetLevel (double level);
+
+  const double MAX_CONGESTION_LEVEL = 16;
+  const double MIN_CONGESTION_LEVEL = 1;
+  double m_congestionLevel;               //congestion이 있을 경우 영상 압축하여 프레임 축소
+  double m_congestionThreshold;           //로스가 일어난 최소 레벨 기록 후에 그 레벨을 못넘게함
+  bool m_useCongestionThreshold;          //컨제스쳔 기준을 설정할지 말지
+  int32_t m_upscale;
+  double m_fractionLost;                  //평활화한 loss 비율
+};
+
+class RtspGccRateController : public RtspRateController
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspGccRateController ();
+
+  enum Signal_t
+  {
+    NORMAL,
+    OVERUSE,
+    UNDERUSE,
+  };
+
+  virtual void Reset (double maxRate);
+  virtual void OnReport (const RtspRateFeedback &feedback);
+  virtual void OnModify (void);
+
+private:
+  Signal_t Detect (const RtspRateFeedback &feedback);
+
+  double m_startRateFraction; //최대 대비 시작 비트레이트 비율
+  double m_beta;              //overuse 시 감소 비율
+  double m_increaseFactor;    //초당 증가 비율
+  double m_gainUp;            //threshold 증가 이득 (k_u)
+  double m_gainDown;          //threshold 감소 이득 (k_d)
+  double m_smoothing;         //delay 기울기 평활화 계수
+
+  double m_delayRate;         //delay 기반 비트레이트
+  double m_lossRate;          //loss 기반 비트레이트
+  double m_gradient;          //평활화한 delay 기울기 (ms)
+  double m_threshold;         //적응형 overuse threshold (ms)
+  Time m_lastDelay;           //직전 보고의 one-way delay
+  Time m_lastReport;          //직전 보고 시각
+  bool m_hold;                //underuse 직후에는 증가하지 않음
+};
+
+class RtspAimdRateController : public RtspRateController
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspAimdRateController ();
+
+  virtual void OnReport (const RtspRateFeedback &feedback);
+  virtual void OnModify (void);
+
+private:
+  double m_additiveIncrease;  //보고마다 증가량 (bps)
+  double m_decreaseFactor;    //loss 시 곱하는 비율
+  double m_lossThreshold;     //감소를 시작하는 loss 비율
+};
+
+}
+
+#endif
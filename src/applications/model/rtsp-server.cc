@@ -1,12 +1,11 @@
 /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
 #include "rtsp-server.h"
-#include "seq-ts-header.h"
+#include "rtcp-header.h"
 
 #include <string>
-#include <fstream>
 #include <vector>
+#include <algorithm>
 
-#include <sstream>
 #include <ns3/core-module.h>
 #include <ns3/log.h>
 #include <ns3/simulator.h>
@@ -58,14 +57,132 @@ RtspServer::GetTypeId (void)
                     UintegerValue (11),
                     MakeUintegerAccessor (&RtspServer::m_rtpPort),
                     MakeUintegerChecker<uint16_t> ())
+        .AddAttribute ("MulticastGroup",
+                    "First multicast group used for clients that request multicast in SETUP; "
+                    "each content gets the next address. 0.0.0.0 disables multicast.",
+                    Ipv4AddressValue (Ipv4Address::GetAny ()),
+                    MakeIpv4AddressAccessor (&RtspServer::m_multicastGroup),
+                    MakeIpv4AddressChecker ())
+        .AddAttribute ("MulticastRtpPort",
+                    "Destination port of multicast RTP streams.",
+                    UintegerValue (5004),
+                    MakeUintegerAccessor (&RtspServer::m_multicastRtpPort),
+                    MakeUintegerChecker<uint16_t> ())
         .AddAttribute ("SendDelay",
                     "Frame send delay.",
                     UintegerValue (RtspServer::FRAME_PERIOD),
                     MakeUintegerAccessor (&RtspServer::m_sendDelay),
                     MakeUintegerChecker<uint16_t> ())
+        .AddAttribute ("Mtu",
+                    "MTU used to split a frame into RTP packets (IP and UDP headers included). "
+                    "With FEC enabled, room for the FEC header is reserved so parity packets fit as well.",
+                    UintegerValue (1500),
+                    MakeUintegerAccessor (&RtspServer::m_mtu),
+                    MakeUintegerChecker<uint32_t> (576, 65535))
+        .AddAttribute ("PacingMode",
+                    "Send all RTP packets of a frame at once (Burst) "
+                    "or spread them over the frame interval (Paced).",
+                    EnumValue (RtspServer::BURST),
+                    MakeEnumAccessor (&RtspServer::m_pacingMode),
+                    MakeEnumChecker (RtspServer::BURST, "Burst",
+                                     RtspServer::PACED, "Paced"))
+        .AddAttribute ("PacingGain",
+                    "Pacing rate relative to the rate that exactly fills the frame interval.",
+                    DoubleValue (1.25),
+                    MakeDoubleAccessor (&RtspServer::m_pacingGain),
+                    MakeDoubleChecker<double> (1.0))
+        .AddAttribute ("SwitchingInterval",
+                    "Number of frames between representation switching points (GOP length). "
+                    "Only used when SETUP names more than one trace and the traces carry no "
+                    "frame types; typed traces switch at I-frames.",
+                    UintegerValue (16),
+                    MakeUintegerAccessor (&RtspServer::m_switchingInterval),
+                    MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("FrameDropPolicy",
+                    "Which frames are skipped while the congestion level is at least FrameDropLevel.",
+                    EnumValue (RtspServer::DROP_NONE),
+                    MakeEnumAccessor (&RtspServer::m_frameDropPolicy),
+                    MakeEnumChecker (RtspServer::DROP_NONE, "None",
+                                     RtspServer::DROP_B_FRAMES, "BFrames"))
+        .AddAttribute ("FrameDropLevel",
+                    "Congestion level (original bitrate / target bitrate) at which frames start to be dropped.",
+                    DoubleValue (2.0),
+                    MakeDoubleAccessor (&RtspServer::m_frameDropLevel),
+                    MakeDoubleChecker<double> (1.0))
+        .AddAttribute ("PacketPoolSize",
+                    "Number of payload sizes for which a template RTP packet is kept and copied "
+                    "instead of creating a new packet (0 disables the pool). Pooled packets of the "
+                    "same size share the packet UID of their template, so keep it disabled when "
+                    "traces need to tell packets apart by UID.",
+                    UintegerValue (0),
+                    MakeUintegerAccessor (&RtspServer::m_packetPoolSize),
+                    MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("SendHistorySize",
+                    "Number of sent RTP packets kept per session for NACK retransmission (0 disables it). "
+                    "The history is allocated at SETUP for clients that announce NACK support "
+                    "(for a multicast stream, as soon as one subscriber does), so other sessions keep no copies.",
+                    UintegerValue (1024),
+                    MakeUintegerAccessor (&RtspServer::m_sendHistorySize),
+                    MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("RetransmissionDeadline",
+                    "A NACKed packet is retransmitted only if it was first sent less than this long ago "
+                    "(minus half the RTT), i.e. if it can still reach the client before playout.",
+                    TimeValue (MilliSeconds (300)),
+                    MakeTimeAccessor (&RtspServer::m_retransmissionDeadline),
+                    MakeTimeChecker ())
+        .AddAttribute ("FecGroupSize",
+                    "Number of RTP packets protected by one XOR FEC packet (0 disables FEC). "
+                    "A group also ends at the last packet of a frame.",
+                    UintegerValue (0),
+                    MakeUintegerAccessor (&RtspServer::m_fecGroupSize),
+                    MakeUintegerChecker<uint32_t> (0, 255))
+        .AddAttribute ("AdaptiveFec",
+                    "Derive the FEC group size from the fraction lost reported in RTCP.",
+                    BooleanValue (false),
+                    MakeBooleanAccessor (&RtspServer::m_adaptiveFec),
+                    MakeBooleanChecker ())
+        .AddAttribute ("FecOverheadFactor",
+                    "Adaptive FEC targets an overhead of this factor times the reported fraction lost.",
+                    DoubleValue (2.0),
+                    MakeDoubleAccessor (&RtspServer::m_fecOverheadFactor),
+                    MakeDoubleChecker<double> (0.0))
+        .AddAttribute ("MaxFecGroupSize",
+                    "Largest group used by adaptive FEC; lower losses turn FEC off.",
+                    UintegerValue (20),
+                    MakeUintegerAccessor (&RtspServer::m_maxFecGroupSize),
+                    MakeUintegerChecker<uint32_t> (2, 255))
+        .AddAttribute ("SessionMemoryLimit",
+                    "Bytes a session may hold in its send history, pacing queue, FEC and control "
+                    "buffers (0 means no limit).",
+                    UintegerValue (0),
+                    MakeUintegerAccessor (&RtspServer::m_sessionMemoryLimit),
+                    MakeUintegerChecker<uint64_t> ())
+        .AddAttribute ("MemoryLimitPolicy",
+                    "What is done to a session that exceeds SessionMemoryLimit.",
+                    EnumValue (RtspServer::EVICT_OLDEST),
+                    MakeEnumAccessor (&RtspServer::m_memoryLimitPolicy),
+                    MakeEnumChecker (RtspServer::EVICT_OLDEST, "EvictOldest",
+                                     RtspServer::CLOSE_SESSION, "CloseSession"))
+        .AddAttribute ("StatsCollector",
+                    "Collector that samples the counters of every session.",
+                    PointerValue (),
+                    MakePointerAccessor (&RtspServer::m_statsCollector),
+                    MakePointerChecker<RtspStatsCollector> ())
+        .AddAttribute ("TickDriver",
+                    "Shared driver that sends the RTP frames of every session in one event per period. "
+                    "Without it every session schedules its own send event.",
+                    PointerValue (),
+                    MakePointerAccessor (&RtspServer::m_tickDriver),
+                    MakePointerChecker<RtspTickDriver> ())
+        .AddAttribute ("RateController",
+                    "Type of the rate controller created for every session.",
+                    TypeIdValue (RtspLevelRateController::GetTypeId ()),
+                    MakeTypeIdAccessor (&RtspServer::m_rateControllerType),
+                    MakeTypeIdChecker ())
         .AddAttribute ("UseCongestionThreshold",
-                    "Enable or Disable congestion threshold.",
-                    BooleanValue(&RtspServer::m_useCongestionThreshold),
+                    "Enable or Disable congestion threshold "
+                    "(forwarded to controllers that support it).",
+                    BooleanValue(true),
                     MakeBooleanAccessor (&RtspServer::m_useCongestionThreshold),
                     MakeBooleanChecker ())
         .AddTraceSource ("CongestionLevel",
@@ -73,6 +190,26 @@ RtspServer::GetTypeId (void)
                     MakeTraceSourceAccessor (&RtspServer::m_congestionLevelTrace),
                     "ns3::RtspServer::TracedCallback"
         )
+        .AddTraceSource ("Representation",
+                    "Session id and new representation index, fired on every switch",
+                    MakeTraceSourceAccessor (&RtspServer::m_representationTrace),
+                    "ns3::RtspServer::RepresentationTracedCallback")
+        .AddTraceSource ("FrameDrop",
+                    "Frames skipped by the frame drop policy",
+                    MakeTraceSourceAccessor (&RtspServer::m_frameDropTrace),
+                    "ns3::RtspServer::FrameTracedCallback")
+        .AddTraceSource ("Retransmit",
+                    "RTP packets retransmitted in response to a NACK",
+                    MakeTraceSourceAccessor (&RtspServer::m_retransmitTrace),
+                    "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Fec",
+                    "FEC packets sent",
+                    MakeTraceSourceAccessor (&RtspServer::m_fecTrace),
+                    "ns3::Packet::TracedCallback")
+        .AddTraceSource ("MemoryEviction",
+                    "Session id and bytes released because the session exceeded SessionMemoryLimit",
+                    MakeTraceSourceAccessor (&RtspServer::m_memoryEvictionTrace),
+                    "ns3::RtspServer::MemoryEvictionTracedCallback")
     ;
     return tid;
 }
@@ -84,15 +221,33 @@ RtspServer::RtspServer ()
     m_rtcpPort = 10;
     m_rtpPort = 11;
     m_sendDelay = FRAME_PERIOD;
+    m_mtu = 1500;
+    m_pacingMode = BURST;
+    m_pacingGain = 1.25;
+    m_switchingInterval = 16;
+    m_frameDropPolicy = DROP_NONE;
+    m_frameDropLevel = 2.0;
+    m_sendHistorySize = 1024;
+    m_packetPoolSize = 0;
+    m_tickMember = RtspTickDriver::INVALID;
+    m_ticking = false;
+    m_tickDirty = false;
+    m_retransmissionDeadline = MilliSeconds (300);
+    m_fecGroupSize = 0;
+    m_adaptiveFec = false;
+    m_fecOverheadFactor = 2.0;
+    m_maxFecGroupSize = 20;
+    m_sessionMemoryLimit = 0;
+    m_memoryLimitPolicy = EVICT_OLDEST;
+    m_memoryEvictedBytes = 0;
 
-    m_congestionLevel = MAX_CONGESTION_LEVEL;
-    m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
+    m_rateControllerType = RtspLevelRateController::GetTypeId ();
     m_useCongestionThreshold = true;
     
-    m_frameSizes.resize(0);
-    m_count = 0;
-    m_seqNum = 0;
-    m_upscale = 0;
+    m_nextSessionId = 1;
+    m_multicastGroup = Ipv4Address::GetAny ();
+    m_multicastRtpPort = 5004;
+    m_nextMulticastGroup = 0;
 }
 
 RtspServer::~RtspServer ()
@@ -109,6 +264,18 @@ RtspServer::DoDispose ()
     {
       StopApplication ();
     }
+  m_sessions.clear ();
+  m_rtcpSessions.clear ();
+  m_multicastStreams.clear ();
+  m_statsCollector = 0;
+  if (m_tickDriver != 0 && m_tickMember != RtspTickDriver::INVALID)
+    {
+      m_tickDriver->Remove (m_tickMember);
+    }
+  m_tickMember = RtspTickDriver::INVALID;
+  m_tickSessions.clear ();
+  m_tickDriver = 0;
+  m_packetPool.Clear ();
 
   Application::DoDispose (); // Chain up.
 }
@@ -118,6 +285,8 @@ RtspServer::StartApplication ()
 {
     NS_LOG_FUNCTION (this);
 
+    m_packetPool.SetCapacity(m_packetPoolSize);
+
     /*
       RTSP 소켓 초기화
     */
@@ -180,8 +349,16 @@ void
 RtspServer::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
-  Simulator::Cancel (m_sendEvent);
-  m_state = INIT;
+
+  //모든 세션 종료
+  while (!m_sessions.empty ())
+    {
+      CloseSession (m_sessions.begin ()->second);
+    }
+  while (!m_multicastStreams.empty ())
+    {
+      CloseStream (m_multicastStreams.begin ()->second);
+    }
 
   // Stop listening.
   if (m_rtspSocket != 0)
@@ -199,6 +376,153 @@ RtspServer::StopApplication ()
     m_rtpSocket->Close();
     m_rtpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   }
+  if (m_rtcpSocket != 0)
+  {
+    m_rtcpSocket->Close();
+    m_rtcpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  }
+}
+
+uint32_t
+RtspServer::GetSessionCount() const
+{
+  return m_sessions.size();
+}
+
+uint32_t
+RtspServer::GetMulticastStreamCount() const
+{
+  return m_multicastStreams.size();
+}
+
+RtspMemoryUsage
+RtspServer::GetSessionMemoryUsage(uint32_t sessionId) const
+{
+  for (auto &it : m_sessions)
+    {
+      if (it.second->id == sessionId)
+        {
+          return GetSessionMemoryUsage (it.second);
+        }
+    }
+  for (auto &it : m_multicastStreams)
+    {
+      if (it.second->id == sessionId)
+        {
+          return GetSessionMemoryUsage (it.second);
+        }
+    }
+  return RtspMemoryUsage ();
+}
+
+RtspMemoryUsage
+RtspServer::GetMemoryUsage() const
+{
+  RtspMemoryUsage usage;
+  for (auto &it : m_sessions)
+    {
+      usage += GetSessionMemoryUsage (it.second);
+    }
+  for (auto &it : m_multicastStreams)
+    {
+      usage += GetSessionMemoryUsage (it.second);
+    }
+  return usage;
+}
+
+uint64_t
+RtspServer::GetMemoryEvictedBytes() const
+{
+  return m_memoryEvictedBytes;
+}
+
+const RtpPacketPool &
+RtspServer::GetPacketPool() const
+{
+  return m_packetPool;
+}
+
+//세션이 보관 중인 바이트, 컨테이너는 원소 크기 * 개수로 계산
+RtspMemoryUsage
+RtspServer::GetSessionMemoryUsage(Ptr<Session> session) const
+{
+  RtspMemoryUsage usage;
+  usage.sendHistory = session->sendHistory.capacity () * sizeof (SentPacket) + session->historyBytes;
+  usage.paceQueue = session->paceQueue.size () * sizeof (Ptr<Packet>) + session->paceQueueBytes;
+  usage.fec = session->fecHeader.capacity ();
+  usage.control = sizeof (Session)
+                  + session->representations.capacity () * sizeof (Ptr<RtspFrameTrace>)
+                  + session->representationRates.capacity () * sizeof (double);
+  if (session->rtspRxBuffer != 0)
+    {
+      usage.control += session->rtspRxBuffer->GetSize ();
+    }
+  return usage;
+}
+
+//세션 메모리가 상한을 넘으면 정책에 따라 버리거나 세션 종료, 세션이 종료되면 false
+bool
+RtspServer::EnforceMemoryLimit(Ptr<Session> session)
+{
+  if (m_sessionMemoryLimit == 0)
+    {
+      return true;
+    }
+  uint64_t usage = GetSessionMemoryUsage (session).GetTotal ();
+  if (usage <= m_sessionMemoryLimit)
+    {
+      return true;
+    }
+
+  //multicast 스트림은 여러 클라이언트가 공유하므로 닫지 않음
+  if (m_memoryLimitPolicy == CLOSE_SESSION && session->rtspSocket != 0)
+    {
+      NS_LOG_WARN ("Session " << session->id << " holds " << usage << " bytes, over the limit "
+                   << m_sessionMemoryLimit << "; closing");
+      m_memoryEvictedBytes += usage;
+      m_memoryEvictionTrace (session->id, usage);
+      CloseSession (session);
+      return false;
+    }
+
+  //재전송 가능성이 가장 낮은 오래된 send history부터 버림
+  uint64_t evicted = 0;
+  const uint32_t historySize = session->sendHistory.size ();
+  if (historySize > 0 && session->seqNum > historySize)
+    {
+      session->historyTail = std::max (session->historyTail, session->seqNum - historySize);
+    }
+  while (usage > m_sessionMemoryLimit && historySize > 0 && session->historyTail < session->seqNum)
+    {
+      SentPacket &sent = session->sendHistory[session->historyTail % historySize];
+      if (sent.packet != 0 && sent.seq == session->historyTail)
+        {
+          uint32_t bytes = sent.packet->GetSize ();
+          sent.packet = 0;
+          session->historyBytes -= bytes;
+          usage -= bytes;
+          evicted += bytes;
+        }
+      session->historyTail++;
+    }
+
+  //그래도 넘으면 pacing 대기열의 오래된 패킷을 버림
+  while (usage > m_sessionMemoryLimit && !session->paceQueue.empty ())
+    {
+      uint32_t bytes = session->paceQueue.front ()->GetSize ();
+      session->paceQueue.pop_front ();
+      session->paceQueueBytes -= bytes;
+      usage -= bytes;
+      evicted += bytes;
+    }
+
+  if (evicted > 0)
+    {
+      NS_LOG_INFO ("Session " << session->id << " evicted " << evicted << " bytes, holding " << usage);
+      m_memoryEvictedBytes += evicted;
+      m_memoryEvictionTrace (session->id, evicted);
+    }
+  return true;
 }
 
 bool
@@ -213,17 +537,24 @@ RtspServer::NewConnectionCreatedCallback (Ptr<Socket> socket, const Address &add
 {
   NS_LOG_FUNCTION (this << socket << address);
 
-  // socket->SetCloseCallbacks (MakeCallback (&ThreeGppHttpServer::NormalCloseCallback, this),
-  //                            MakeCallback (&ThreeGppHttpServer::ErrorCloseCallback, this));
+  socket->SetCloseCallbacks (MakeCallback (&RtspServer::HandleRtspClose, this),
+                             MakeCallback (&RtspServer::HandleRtspClose, this));
   socket->SetRecvCallback (MakeCallback (&RtspServer::HandleRtspReceive, this));
 
+  //연결마다 새로운 세션 생성
   InetSocketAddress inetSocket = InetSocketAddress::ConvertFrom(address);
   Ipv4Address ipv4 = Ipv4Address::ConvertFrom(inetSocket.GetIpv4());
-  m_clientAddress = ipv4;
-  inetSocket = InetSocketAddress(ipv4, m_rtpPort);
-  m_rtpSocket->Connect (inetSocket);
 
-  m_sendEvent = Simulator::Schedule(Seconds(0), &RtspServer::ScheduleRtpSend, this);
+  Ptr<Session> session = CreateSession ();
+  session->rtspSocket = socket;
+  session->rtspRxBuffer = Create<Packet> ();
+  session->rtpAddress = InetSocketAddress(ipv4, m_rtpPort);
+  session->rtcpAddress = InetSocketAddress(ipv4, m_rtcpPort);
+
+  m_sessions[socket] = session;
+  m_rtcpSessions[session->rtcpAddress] = session;
+  NS_LOG_INFO ("Session " << session->id << " created for " << ipv4);
+
   /*
    * A typical connection is established after receiving an empty (i.e., no
    * data) TCP packet with ACK flag. The actual data will follow in a separate
@@ -237,12 +568,145 @@ RtspServer::NewConnectionCreatedCallback (Ptr<Socket> socket, const Address &add
   HandleRtspReceive (socket);
 }
 
+//기본 값으로 초기화된 세션 생성
+Ptr<RtspServer::Session>
+RtspServer::CreateSession ()
+{
+  Ptr<Session> session = Create<Session> ();
+  session->id = m_nextSessionId++;
+  session->state = INIT;
+  session->representation = 0;
+  session->frameCount = 0;
+  session->frameIndex = 0;
+  session->seqNum = 0;
+  session->maxRate = 0;
+  session->congestionLevel = 1;
+  session->paceQueueBytes = 0;
+  session->paceRate = 0;
+  session->paceTokens = m_mtu;
+  session->historyBytes = 0;
+  session->historyTail = 0;
+  session->fecGroupSize = m_fecGroupSize;
+  session->fecSeq = 0;
+  session->fecBaseSeq = 0;
+  session->fecCount = 0;
+  session->fecLength = 0;
+  session->fecMaxLength = 0;
+  session->subscribers = 0;
+  session->viewers = 0;
+  session->statsSlot = 0;
+  session->tickIndex = RtspTickDriver::INVALID;
+  if (m_statsCollector != 0)
+    {
+      session->statsSlot = m_statsCollector->Register (RtspStatsCollector::SERVER,
+                                                       GetNode ()->GetId (), session->id);
+    }
+  return session;
+}
+
+void
+RtspServer::HandleRtspClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  auto it = m_sessions.find (socket);
+  if (it != m_sessions.end ())
+    {
+      CloseSession (it->second);
+    }
+}
+
+//세션 정리 및 테이블에서 제거
+void
+RtspServer::CloseSession (Ptr<Session> session)
+{
+  NS_LOG_FUNCTION (this << session->id);
+
+  Unsubscribe (session);
+  session->state = INIT;
+  StopSendTimer (session);
+  Simulator::Cancel (session->paceEvent);
+  session->paceQueue.clear ();
+  session->paceQueueBytes = 0;
+  session->sendHistory.clear ();
+  session->historyBytes = 0;
+  session->representations.clear ();
+  session->trace = 0;
+
+  Ptr<Socket> socket = session->rtspSocket;
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+
+  if (m_statsCollector != 0)
+    {
+      m_statsCollector->Unregister (session->statsSlot);
+    }
+  m_rtcpSessions.erase (session->rtcpAddress);
+  m_sessions.erase (socket);
+  NS_LOG_INFO ("Session " << session->id << " closed");
+}
+
+//multicast 스트림 시청 종료, 마지막 클라이언트가 나가면 스트림도 정리
+void
+RtspServer::Unsubscribe (Ptr<Session> session)
+{
+  Ptr<Session> stream = session->stream;
+  if (stream == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << session->id << stream->id);
+
+  session->stream = 0;
+  if (session->state == PLAYING && --stream->viewers == 0)
+    {
+      stream->state = READY;
+    }
+  if (--stream->subscribers == 0)
+    {
+      CloseStream (stream);
+    }
+}
+
+void
+RtspServer::CloseStream (Ptr<Session> stream)
+{
+  NS_LOG_FUNCTION (this << stream->id);
+
+  stream->state = INIT;
+  StopSendTimer (stream);
+  Simulator::Cancel (stream->paceEvent);
+  stream->paceQueue.clear ();
+  stream->paceQueueBytes = 0;
+  stream->sendHistory.clear ();
+  stream->historyBytes = 0;
+  stream->representations.clear ();
+  stream->trace = 0;
+  if (m_statsCollector != 0)
+    {
+      m_statsCollector->Unregister (stream->statsSlot);
+    }
+
+  m_multicastStreams.erase (stream->url);
+  NS_LOG_INFO ("Multicast stream " << stream->id << " for " << stream->url << " closed");
+}
+
 //RTSP handler
 void
 RtspServer::HandleRtspReceive (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION(this << socket);
 
+  auto it = m_sessions.find (socket);
+  if (it == m_sessions.end ())
+  {
+    NS_LOG_WARN ("Server Rtsp: no session for socket " << socket);
+    return;
+  }
+  Ptr<Session> session = it->second;
+
   Ptr<Packet> packet;
   while((packet = socket->Recv()))
   {
@@ -250,72 +714,155 @@ RtspServer::HandleRtspReceive (Ptr<Socket> socket)
     {
       break;
     }
-    //요청 버퍼
-    uint8_t* msg = new uint8_t[packet->GetSize()+1];
-    packet->CopyData(msg, packet->GetSize());
-    std::istringstream req((char*)msg);
 
-    //응답 버퍼
-    std::ostringstream res;
+    //TCP 스트림을 RTSP 메시지 단위로 나눔
+    session->rtspRxBuffer->AddAtEnd(packet);
+    uint32_t messageSize;
+    while((messageSize = RtspHeader::PeekMessageSize(session->rtspRxBuffer)) != 0
+          && session->rtspRxBuffer->GetSize() >= messageSize)
+    {
+      RtspHeader request;
+      session->rtspRxBuffer->RemoveHeader(request);
+      HandleRtspRequest(session, request);
+    }
+  }
+}
 
-    std::string method;
-    req >> method;
+//RTSP 요청 처리 후 응답 전송
+void
+RtspServer::HandleRtspRequest (Ptr<Session> session, const RtspHeader &request)
+{
+  NS_LOG_FUNCTION(this << session->id << request);
 
-    res << method << '\n';
-    res << 200 << '\n';
+  RtspHeader response;
+  response.SetMethod(request.GetMethod());
+  response.SetCSeq(request.GetCSeq());
+  response.SetSession(session->id);
+  response.SetStatus(RtspHeader::OK);
 
-    //SETUP인 경우에 파일 열어서 보내기 시작
-    if (method.compare("SETUP") == 0) {
-      m_state = READY;
+  //SETUP 이외에는 세션 ID가 맞아야 함
+  if(request.GetMethod() != RtspHeader::SETUP && request.GetSession() != session->id)
+  {
+    NS_LOG_ERROR("Server Rtsp: Session not found " << request.GetSession());
+    response.SetStatus(RtspHeader::SESSION_NOT_FOUND);
+  }
+  //SETUP인 경우에 트레이스를 불러와서 처음부터 보내기 시작
+  else if (request.GetMethod() == RtspHeader::SETUP) {
+    //Transport에 클라이언트 포트가 있으면 사용
+    Ipv4Address ipv4 = InetSocketAddress::ConvertFrom(session->rtpAddress).GetIpv4();
+    if(request.GetClientRtpPort() != 0)
+    {
+      session->rtpAddress = InetSocketAddress(ipv4, request.GetClientRtpPort());
+    }
+    if(request.GetClientRtcpPort() != 0)
+    {
+      m_rtcpSessions.erase(session->rtcpAddress);
+      session->rtcpAddress = InetSocketAddress(ipv4, request.GetClientRtcpPort());
+      m_rtcpSessions[session->rtcpAddress] = session;
+    }
+    response.SetClientPorts(InetSocketAddress::ConvertFrom(session->rtpAddress).GetPort(),
+                            InetSocketAddress::ConvertFrom(session->rtcpAddress).GetPort());
 
-      //이미 열려있는 경우 파일 스트림을 닫고 다시 엶
-      if(m_fileStream.is_open())
+    Unsubscribe(session);
+    session->frameIndex = 0;
+    session->url = request.GetUrl();
+    if(request.IsMulticast() && m_multicastGroup != Ipv4Address::GetAny())
+    {
+      //같은 URL의 multicast 스트림을 공유
+      Ptr<Session> stream = GetMulticastStream(session->url);
+      if(stream == 0)
       {
-        m_fileStream.close();
+        session->state = INIT;
+        response.SetStatus(RtspHeader::NOT_FOUND);
+      }
+      else
+      {
+        session->representations.clear();
+        session->representationRates.clear();
+        session->trace = 0;
+        session->stream = stream;
+        stream->subscribers++;
+        session->state = READY;
+        //multicast 시청자는 스트림의 타이머로 받으므로 자신의 전송 타이머는 없음
+        StopSendTimer(session);
+        response.SetFramePeriod(FRAME_PERIOD);
+        response.SetFrameCount(stream->frameCount);
+        response.SetMulticast(true);
+        response.SetDestination(InetSocketAddress::ConvertFrom(stream->rtpAddress).GetIpv4());
+        response.SetClientPorts(m_multicastRtpPort,
+                                InetSocketAddress::ConvertFrom(session->rtcpAddress).GetPort());
+        //재전송은 스트림의 send history에서 하므로 시청자 하나라도 NACK을 쓰면 스트림에 할당
+        response.SetNack(request.IsNack() && EnableSendHistory(stream));
       }
-      std::string fileName;
-      req >> fileName;
-      m_fileStream.open(fileName);
-
-      res << FRAME_PERIOD << '\n';
-
-      NS_LOG_INFO ("File open: " << m_fileStream.is_open () ); 
     }
-    else if (method.compare("PLAY") == 0)
+    else if(!SetupStream(session, session->url))
     {
-      m_state = PLAYING;
+      session->state = INIT;
+      StopSendTimer(session);
+      response.SetStatus(RtspHeader::NOT_FOUND);
     }
-    else if (method.compare("PAUSE") == 0)
+    else
     {
-      m_state = READY;
+      //unicast로 정해진 뒤에 전송 타이머 시작
+      session->state = READY;
+      StartSendTimer(session);
+      response.SetFramePeriod(FRAME_PERIOD);
+      response.SetFrameCount(session->frameCount);
+      response.SetNack(request.IsNack() && EnableSendHistory(session));
     }
-    else if (method.compare("MODIFY"))
+
+    NS_LOG_INFO ("Session " << session->id << " trace load: " << (session->trace != 0 || session->stream != 0)
+                 << " representations: " << session->representations.size ()
+                 << (session->stream != 0 ? " (multicast)" : "")); 
+  }
+  else if (request.GetMethod() == RtspHeader::PLAY)
+  {
+    //multicast 스트림은 시청자가 있을 때만 전송
+    if(session->stream != 0 && session->state != PLAYING)
     {
-      if(m_congestionLevel > MIN_CONGESTION_LEVEL)
-      {
-        NS_LOG_INFO("Server Congestion Modified to "<<m_congestionLevel);
-        m_congestionLevel /= 2;
-        m_congestionLevelTrace(m_congestionLevel);
-        m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
-      }
+      session->stream->viewers++;
+      session->stream->state = PLAYING;
     }
-    //TEARDOWN인 경우에 파일 스트림 종료
-    else if (method.compare("TEARDOWN") == 0)
+    session->state = PLAYING;
+  }
+  else if (request.GetMethod() == RtspHeader::PAUSE)
+  {
+    if(session->stream != 0 && session->state == PLAYING && --session->stream->viewers == 0)
     {
-      m_state = INIT;
-      m_fileStream.close();
-
-      NS_LOG_INFO ("File close: " << !m_fileStream.is_open () ); 
+      session->stream->state = READY;
     }
-    else
+    session->state = READY;
+  }
+  else if (request.GetMethod() == RtspHeader::MODIFY)
+  {
+    Ptr<Session> target = session->stream != 0 ? session->stream : session;
+    if(target->rateController != 0)
     {
-      NS_LOG_ERROR("Server Rtsp: Parsing Error");
+      target->rateController->OnModify();
+      UpdateCongestionLevel(target);
+      NS_LOG_INFO("Server Congestion Modified to "<<target->congestionLevel);
     }
-    Ptr<Packet> response = Create<Packet>((uint8_t*)res.str().c_str(), 100);
-    socket->Send(response);
+  }
+  //TEARDOWN인 경우에 트레이스 반납
+  else if (request.GetMethod() == RtspHeader::TEARDOWN)
+  {
+    Unsubscribe(session);
+    session->state = INIT;
+    session->representations.clear();
+    session->representationRates.clear();
+    session->trace = 0;
 
-    delete msg;
+    NS_LOG_INFO ("Session " << session->id << " teardown"); 
+  }
+  else
+  {
+    NS_LOG_ERROR("Server Rtsp: Parsing Error");
+    response.SetStatus(RtspHeader::BAD_REQUEST);
   }
+
+  Ptr<Packet> packet = Create<Packet>();
+  packet->AddHeader(response);
+  session->rtspSocket->Send(packet);
 }
 
 //RTCP handler
@@ -326,80 +873,694 @@ RtspServer::HandleRtcpReceive(Ptr<Socket> socket)
 
   Ptr<Packet> packet;
   Address from;
-  Address localAddress;
   while ((packet = socket->RecvFrom (from)))
   {
-    socket->GetSockName (localAddress);
+    //보낸 클라이언트의 세션 탐색
+    auto it = m_rtcpSessions.find (from);
+    if (it == m_rtcpSessions.end ())
+    {
+      NS_LOG_WARN ("Server Rtcp: no session for " << from);
+      continue;
+    }
+    //multicast 시청자의 보고는 스트림에 반영
+    Ptr<Session> viewer = it->second;
+    Ptr<Session> session = viewer->stream != 0 ? viewer->stream : viewer;
+
+    //RTCP 패킷 타입에 따라 처리
+    RtcpCommonHeader common;
+    packet->PeekHeader(common);
+    if(common.GetPacketType() == RtcpReceiverReportHeader::PT_RR)
+    {
+      HandleReceiverReport(session, packet);
+    }
+    else if(common.GetPacketType() == RtcpNackHeader::PT_RTPFB
+            && common.GetCount() == RtcpNackHeader::FMT_GENERIC_NACK)
+    {
+      //multicast 스트림의 재전송은 그룹 전체가 아니라 NACK을 보낸 시청자에게만 unicast로 보냄
+      //시청자의 RTP 소켓은 multicast RTP 포트에 바인드되어 있음
+      Address repairAddress = session->rtpAddress;
+      if(viewer->stream != 0)
+      {
+        repairAddress = InetSocketAddress(InetSocketAddress::ConvertFrom(viewer->rtpAddress).GetIpv4(),
+                                          m_multicastRtpPort);
+      }
+      HandleNack(session, packet, repairAddress);
+    }
+    else
+    {
+      NS_LOG_WARN("Server Rtcp: unknown packet " << common);
+    }
+  }
+}
+
+//RTCP RR 처리, 전송률 제어에 피드백 전달
+void
+RtspServer::HandleReceiverReport(Ptr<Session> session, Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << session->id);
+
+    RtcpReceiverReportHeader report;
+    packet->RemoveHeader(report);
+
+    Time rtt = report.GetRoundTripTime(Simulator::Now());
+    if(!rtt.IsZero())
+    {
+      session->rtt = rtt;
+    }
+    session->jitter = report.GetJitter();
+    if(!report.GetOneWayDelay().IsZero())
+    {
+      session->oneWayDelay = report.GetOneWayDelay();
+    }
+
+    double fractionLost = report.GetFractionLost();
+    if(m_statsCollector != 0)
+    {
+      m_statsCollector->SetLoss(session->statsSlot, std::max(report.GetCumulativeLost(), 0));
+    }
+    if(m_adaptiveFec)
+    {
+      UpdateFecGroupSize(session, fractionLost);
+    }
+    if(session->state == PLAYING && session->rateController != 0) {
+      RtspRateFeedback feedback;
+      feedback.fractionLost = fractionLost;
+      feedback.rtt = session->rtt;
+      feedback.jitter = session->jitter;
+      feedback.oneWayDelay = report.GetOneWayDelay();
+      feedback.now = Simulator::Now();
+      session->rateController->OnReport(feedback);
+      UpdateCongestionLevel(session);
+    }
 
-    uint8_t* msg = new uint8_t[packet->GetSize()+1];
-    packet->CopyData(msg, packet->GetSize());
-    std::istringstream req((char*)msg);
+    NS_LOG_INFO("Server FractionLost : " << fractionLost << " with congestion " << session->congestionLevel
+                << " in session " << session->id << " (rtt " << session->rtt.GetMilliSeconds() << "ms, jitter "
+                << session->jitter.GetMicroSeconds() << "us, owd " << session->oneWayDelay.GetMicroSeconds() << "us)");
+}
+
+//RTCP NACK 처리, send history에 남아 있고 재생 시점 전에 도착할 수 있는 패킷만 repairAddress로 재전송
+void
+RtspServer::HandleNack(Ptr<Session> session, Ptr<Packet> packet, const Address &repairAddress)
+{
+    NS_LOG_FUNCTION(this << session->id);
 
-    float fractionLost;
-    req >> fractionLost;
+    RtcpNackHeader nack;
+    packet->RemoveHeader(nack);
+    NS_LOG_INFO("Server Rtcp Nack: " << nack << " in session " << session->id);
 
-    if(m_state == PLAYING) {
-      if(fractionLost >= 0 && fractionLost <= 0.05)
+    //SETUP에서 NACK 사용을 알리지 않은 세션은 보관한 패킷이 없음
+    if(session->sendHistory.empty())
+    {
+      NS_LOG_LOGIC("Session " << session->id << " keeps no send history");
+      return;
+    }
+    if(session->seqNum == 0)
+    {
+      return;
+    }
+
+    const uint32_t highestSeq = session->seqNum - 1;
+    const Time now = Simulator::Now();
+    for(uint16_t pid : nack.GetLostSequences())
+    {
+      //16비트 PID를 보낸 시퀀스 중 가장 가까운 값으로 확장
+      uint32_t seq = (highestSeq & 0xffff0000) | pid;
+      if(seq > highestSeq)
       {
-        if(
-          m_upscale == int(MAX_CONGESTION_LEVEL + 2 - m_congestionLevel)
-          && m_congestionLevel > MIN_CONGESTION_LEVEL
-          && ( 
-              !m_useCongestionThreshold || 
-              (m_congestionThreshold > MAX_CONGESTION_LEVEL || m_congestionLevel > m_congestionThreshold)
-          )
-        ) 
+        if(seq < 0x10000)
         {
-          m_congestionLevel /= 2;
-          m_upscale = 0;
-          m_congestionLevelTrace(m_congestionLevel);
+          continue;
         }
-        else m_upscale++;
+        seq -= 0x10000;
       }
-      else if(fractionLost > 0.2) 
+
+      SentPacket &sent = session->sendHistory[seq % session->sendHistory.size()];
+      if(sent.packet == 0 || sent.seq != seq)
       {
-        if(m_congestionLevel < MAX_CONGESTION_LEVEL) {
-          m_congestionLevelTrace(m_congestionLevel);
-          m_congestionLevel *= 2;
-        }
-        if(m_congestionThreshold > m_congestionLevel) {
-          m_congestionThreshold = m_congestionLevel;
+        NS_LOG_LOGIC("Server Rtp seq " << seq << " no longer in send history");
+        continue;
+      }
+      if(now - sent.sent + Time(session->rtt.GetTimeStep() / 2) > m_retransmissionDeadline)
+      {
+        NS_LOG_LOGIC("Server Rtp seq " << seq << " would miss its playout deadline");
+        continue;
+      }
+
+      //재전송은 pacing 대기열을 거치지 않고 바로 보냄
+      Ptr<Packet> copy = sent.packet->Copy();
+      m_retransmitTrace(copy);
+      m_rtpSocket->SendTo(copy, 0, repairAddress);
+      if(m_statsCollector != 0)
+      {
+        m_statsCollector->AddPacket(session->statsSlot, copy->GetSize());
+      }
+      NS_LOG_INFO("Server Rtp Retransmit: seq " << seq << " to session " << session->id << " at " << repairAddress);
+    }
+}
+
+//Rtp 패킷을 m_sendDelay 마다 반복해서 보냄
+void
+RtspServer::ScheduleRtpSend(Ptr<Session> session)
+{
+    NS_LOG_FUNCTION(this << session->id);
+
+    NS_ASSERT (m_tickDriver != 0 || session->sendEvent.IsExpired ());
+
+    if(session->state == PLAYING && session->trace != 0
+       && session->frameIndex < session->frameCount) {
+      //representation은 switching point(GOP 시작)에서만 바꿈
+      uint32_t frameId = session->frameIndex++;
+      bool switchingPoint = session->trace->HasFrameTypes()
+                            ? session->trace->GetFrameType(frameId) == RtspFrameTrace::I_FRAME
+                            : frameId % m_switchingInterval == 0;
+      if(switchingPoint)
+      {
+        SelectRepresentation(session);
+      }
+
+      //representation이 하나뿐이면 congestionLevel에 따른 frame 크기 설정
+      uint32_t frameSize = session->trace->GetFrameSize(frameId);
+      uint32_t frameSizeCongestion = session->representations.size() > 1
+                                     ? frameSize : frameSize / session->congestionLevel;
+
+      //congestion 시 다른 프레임이 참조하지 않는 B 프레임은 보내지 않음
+      if(m_frameDropPolicy == DROP_B_FRAMES && session->congestionLevel >= m_frameDropLevel
+         && session->trace->GetFrameType(frameId) == RtspFrameTrace::B_FRAME)
+      {
+        NS_LOG_INFO("Server Rtp Drop: B frame " << frameId << " to session " << session->id);
+        m_frameDropTrace(session->id, frameId, frameSizeCongestion);
+      }
+      else
+      {
+        SendFrame(session, frameId, frameSizeCongestion);
+        NS_LOG_INFO("Server Rtp Send: "<< frameSizeCongestion << " bytes in frame "<< frameId
+                    << " to session " << session->id);
+      }
+    }
+
+    if(!EnforceMemoryLimit(session))
+    {
+      return;
+    }
+
+    //공유 tick 드라이버가 있으면 드라이버가 다음 주기에 다시 호출
+    if(m_tickDriver == 0)
+    {
+      session->sendEvent = Simulator::Schedule(MilliSeconds(m_sendDelay), &RtspServer::ScheduleRtpSend, this, session);
+    }
+}
+
+//세션의 RTP 전송 타이머 시작
+//드라이버가 있으면 세션을 서버의 밀집 배열에 넣고, 서버는 드라이버에 멤버 하나만 등록해서 tick마다 배열을 순회
+void
+RtspServer::StartSendTimer(Ptr<Session> session)
+{
+    if(m_tickDriver == 0)
+    {
+      if(!session->sendEvent.IsRunning())
+      {
+        session->sendEvent = Simulator::Schedule(Seconds(0), &RtspServer::ScheduleRtpSend, this, session);
+      }
+      return;
+    }
+    if(session->tickIndex != RtspTickDriver::INVALID)
+    {
+      return;
+    }
+    session->tickIndex = m_tickSessions.size();
+    m_tickSessions.push_back(session);
+    if(m_tickMember == RtspTickDriver::INVALID)
+    {
+      m_tickMember = m_tickDriver->Add(MilliSeconds(m_sendDelay), MakeCallback(&RtspServer::SendTick, this));
+    }
+}
+
+void
+RtspServer::StopSendTimer(Ptr<Session> session)
+{
+    Simulator::Cancel(session->sendEvent);
+    uint32_t index = session->tickIndex;
+    if(index == RtspTickDriver::INVALID)
+    {
+      return;
+    }
+    session->tickIndex = RtspTickDriver::INVALID;
+
+    //tick 도중에는 배열 위치를 바꾸지 않고 tick이 끝난 뒤 정리
+    if(m_ticking)
+    {
+      m_tickSessions[index] = 0;
+      m_tickDirty = true;
+      return;
+    }
+    //마지막 원소와 교환해서 제거
+    if(index + 1 != m_tickSessions.size())
+    {
+      m_tickSessions[index] = m_tickSessions.back();
+      m_tickSessions[index]->tickIndex = index;
+    }
+    m_tickSessions.pop_back();
+    if(m_tickSessions.empty() && m_tickMember != RtspTickDriver::INVALID)
+    {
+      m_tickDriver->Remove(m_tickMember);
+      m_tickMember = RtspTickDriver::INVALID;
+    }
+}
+
+//공유 tick: 전송 타이머가 켜진 모든 세션의 RTP 전송
+void
+RtspServer::SendTick()
+{
+    NS_LOG_FUNCTION(this << m_tickSessions.size());
+
+    //tick 도중 시작된 세션은 다음 tick부터 보냄
+    m_ticking = true;
+    const uint32_t count = m_tickSessions.size();
+    for(uint32_t i = 0; i < count; i++)
+    {
+      Ptr<Session> session = m_tickSessions[i];
+      if(session != 0)
+      {
+        ScheduleRtpSend(session);
+      }
+    }
+    m_ticking = false;
+
+    if(m_tickDirty)
+    {
+      uint32_t live = 0;
+      for(uint32_t i = 0; i < m_tickSessions.size(); i++)
+      {
+        if(m_tickSessions[i] == 0)
+        {
+          continue;
         }
-        m_upscale = 0;
+        m_tickSessions[live] = m_tickSessions[i];
+        m_tickSessions[live]->tickIndex = live;
+        live++;
       }
+      m_tickSessions.resize(live);
+      m_tickDirty = false;
     }
+    if(m_tickSessions.empty() && m_tickMember != RtspTickDriver::INVALID)
+    {
+      m_tickDriver->Remove(m_tickMember);
+      m_tickMember = RtspTickDriver::INVALID;
+    }
+}
 
-    NS_LOG_INFO("Server FractionLost : " << fractionLost << " with congestion " << m_congestionLevel);
-  }
+//전송률 제어 결과를 congestion level로 반영
+void
+RtspServer::UpdateCongestionLevel(Ptr<Session> session)
+{
+    double targetRate = session->rateController->GetTargetRate();
+    double congestionLevel = targetRate > 0 ? session->maxRate / targetRate : 1;
+    if(congestionLevel != session->congestionLevel)
+    {
+      session->congestionLevel = congestionLevel;
+      m_congestionLevelTrace(session->congestionLevel);
+      if(m_statsCollector != 0)
+      {
+        m_statsCollector->SetCongestionLevel(session->statsSlot, congestionLevel);
+      }
+    }
 }
 
-//Rtp 패킷을 m_sendDelay 마다 반복해서 보냄
+//트레이스를 불러오고 트레이스 비트레이트 기준으로 전송률 제어 초기화
+bool
+RtspServer::SetupStream(Ptr<Session> session, const std::string &url)
+{
+    NS_LOG_FUNCTION(this << session->id << url);
+
+    if(!LoadRepresentations(session, url))
+    {
+      return false;
+    }
+
+    ObjectFactory factory;
+    factory.SetTypeId(m_rateControllerType);
+    session->rateController = factory.Create<RtspRateController>();
+    session->rateController->SetAttributeFailSafe("UseCongestionThreshold", BooleanValue(m_useCongestionThreshold));
+
+    session->maxRate = session->representationRates.back();
+    session->rateController->Reset(session->maxRate);
+    UpdateCongestionLevel(session);
+    SelectRepresentation(session);
+    return true;
+}
+
+//URL의 multicast 스트림 반환, 없으면 새 그룹 주소로 생성
+Ptr<RtspServer::Session>
+RtspServer::GetMulticastStream(const std::string &url)
+{
+    NS_LOG_FUNCTION(this << url);
+
+    auto it = m_multicastStreams.find(url);
+    if(it != m_multicastStreams.end())
+    {
+      return it->second;
+    }
+
+    Ptr<Session> stream = CreateSession();
+    stream->url = url;
+    if(!SetupStream(stream, url))
+    {
+      return 0;
+    }
+    Ipv4Address group(m_multicastGroup.Get() + m_nextMulticastGroup++);
+    NS_ASSERT_MSG(group.IsMulticast(), "Multicast group range exhausted at " << group);
+    stream->rtpAddress = InetSocketAddress(group, m_multicastRtpPort);
+    stream->state = READY;
+    m_multicastStreams[url] = stream;
+    StartSendTimer(stream);
+
+    NS_LOG_INFO("Multicast stream " << stream->id << " for " << url << " on " << group);
+    return stream;
+}
+
+//SETUP URL의 트레이스들을 불러와서 비트레이트 오름차순으로 정렬
+bool
+RtspServer::LoadRepresentations(Ptr<Session> session, const std::string &url)
+{
+    NS_LOG_FUNCTION(this << session->id << url);
+
+    std::vector<std::pair<double, Ptr<RtspFrameTrace> > > ladder;
+    uint32_t frameCount = 0;
+    std::string::size_type begin = 0;
+    while(begin <= url.size())
+    {
+      std::string::size_type end = std::min(url.find(',', begin), url.size());
+      Ptr<RtspFrameTrace> trace = RtspFrameTrace::Load(url.substr(begin, end - begin));
+      if(trace == 0 || trace->GetFrameCount() == 0)
+      {
+        NS_LOG_ERROR("Server Rtsp: cannot load representation " << url.substr(begin, end - begin));
+        session->representations.clear();
+        session->representationRates.clear();
+        session->trace = 0;
+        return false;
+      }
+      frameCount = ladder.empty() ? trace->GetFrameCount() : std::min(frameCount, trace->GetFrameCount());
+      double rate = trace->GetTotalBytes() * 8.0 * 1000 / (trace->GetFrameCount() * m_sendDelay);
+      ladder.push_back(std::make_pair(rate, trace));
+      begin = end + 1;
+    }
+    NS_ASSERT_MSG(ladder.size() <= 0xff, "Too many representations");
+    std::stable_sort(ladder.begin(), ladder.end(),
+                     [](const std::pair<double, Ptr<RtspFrameTrace> > &a,
+                        const std::pair<double, Ptr<RtspFrameTrace> > &b) { return a.first < b.first; });
+
+    session->representations.clear();
+    session->representationRates.clear();
+    for(auto &rep : ladder)
+    {
+      session->representationRates.push_back(rep.first);
+      session->representations.push_back(rep.second);
+    }
+    session->frameCount = frameCount;
+    session->representation = 0;
+    session->trace = session->representations.front();
+    return true;
+}
+
+//목표 비트레이트를 넘지 않는 가장 높은 representation 선택
+void
+RtspServer::SelectRepresentation(Ptr<Session> session)
+{
+    NS_LOG_FUNCTION(this << session->id);
+
+    if(session->representations.size() <= 1 || session->rateController == 0)
+    {
+      return;
+    }
+
+    double targetRate = session->rateController->GetTargetRate();
+    uint32_t representation = 0;
+    while(representation + 1 < session->representations.size()
+          && session->representationRates[representation + 1] <= targetRate)
+    {
+      representation++;
+    }
+
+    if(representation != session->representation)
+    {
+      NS_LOG_INFO("Session " << session->id << " representation " << session->representation
+                  << " -> " << representation << " at frame " << session->frameIndex);
+      session->representation = representation;
+      session->trace = session->representations[representation];
+      m_representationTrace(session->id, representation);
+    }
+}
+
+//프레임을 MTU에 맞는 RTP 패킷들로 나누어 전송
 void
-RtspServer::ScheduleRtpSend()
+RtspServer::SendFrame(Ptr<Session> session, uint32_t frameId, uint32_t frameSize)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << session->id << frameId << frameSize);
+
+    RtpHeader rtp;
+    uint32_t maxPayload = m_mtu - IPV4_UDP_HEADER_SIZE - rtp.GetSerializedSize();
+    if(m_fecGroupSize > 0 || m_adaptiveFec)
+    {
+      //FEC 패킷은 가장 긴 페이로드에 FEC 헤더를 더해 보내므로, 그것도 MTU에 맞도록 미리 비워 둠
+      static const uint32_t fecHeaderSize = RtpFecHeader().GetSerializedSize();
+      maxPayload -= fecHeaderSize;
+    }
+    const uint32_t fragmentCount = std::max<uint32_t>(1, (frameSize + maxPayload - 1) / maxPayload);
+    NS_ASSERT (fragmentCount <= 0xffff);
 
-    NS_ASSERT (m_sendEvent.IsExpired ());
+    //프레임 타입과 참조 관계는 현재 representation의 트레이스에서 가져옴
+    rtp.SetFrameType (session->trace->GetFrameType(frameId));
+    rtp.SetReferenceDistance (std::min<uint32_t>(0xffff, frameId - session->trace->GetReference(frameId)));
 
-    if(!m_fileStream.eof() && m_state == PLAYING) {
-      //header seqTs에 현재 seqNum 저장
-      SeqTsHeader seqTs;
-      seqTs.SetSeq (m_seqNum);
+    uint32_t remaining = frameSize;
+    for(uint32_t idx = 0; idx < fragmentCount; idx++)
+    {
+      uint32_t payloadSize = std::min(remaining, maxPayload);
+      remaining -= payloadSize;
 
-      // congestionLevel에 따른 frame 크기 설정
-      uint32_t frameSize;
-      m_fileStream >> frameSize;
-      uint32_t frameSizeCongestion = frameSize / m_congestionLevel;
+      //header에 현재 seqNum과 프레임 분할 정보 저장
+      rtp.SetSeq (session->seqNum++);
+      rtp.SetFrameId (frameId);
+      rtp.SetFragmentIndex (idx);
+      rtp.SetFragmentCount (fragmentCount);
+      rtp.SetMarker (idx == fragmentCount - 1);
+      rtp.SetRepresentation (session->representation);
 
-      Ptr<Packet> packet = Create<Packet>(frameSizeCongestion);
-      packet->AddHeader (seqTs);
-      
-      m_rtpSocket->Send(packet);
-      NS_LOG_INFO("Server Rtp Send: "<< frameSizeCongestion << " bytes in "<< m_seqNum);
-      m_seqNum++;
+      Ptr<Packet> packet = m_packetPool.Create(payloadSize);
+      packet->AddHeader (rtp);
+      if(m_pacingMode == BURST)
+      {
+        SendRtpPacket(session, packet);
+      }
+      else
+      {
+        session->paceQueue.push_back(packet);
+        session->paceQueueBytes += packet->GetSize();
+      }
     }
 
-    m_sendEvent = Simulator::Schedule(MilliSeconds(m_sendDelay), &RtspServer::ScheduleRtpSend, this);
+    if(m_pacingMode == PACED && !session->paceQueue.empty())
+    {
+      //남은 패킷 전체를 한 프레임 간격 안에 보낼 수 있는 속도
+      session->paceRate = m_pacingGain * session->paceQueueBytes * 1000.0 / m_sendDelay;
+      if(session->fecGroupSize > 0)
+      {
+        //전송 중에 추가될 FEC 패킷 몫
+        session->paceRate *= 1.0 + 1.0 / session->fecGroupSize;
+      }
+      if(session->paceEvent.IsExpired())
+      {
+        PaceRtpSend(session);
+      }
+    }
+}
+
+//NACK 재전송용 send history 할당, 할당되어 있거나 새로 할당했으면 true
+bool
+RtspServer::EnableSendHistory(Ptr<Session> session)
+{
+    if(m_sendHistorySize == 0)
+    {
+      return false;
+    }
+    if(session->sendHistory.empty())
+    {
+      NS_LOG_INFO("Session " << session->id << " starts keeping " << m_sendHistorySize << " packets for NACK");
+      session->sendHistory.resize(m_sendHistorySize);
+      session->historyTail = session->seqNum;
+    }
+    return true;
+}
+
+//RTP 패킷을 전송하고 send history와 FEC 묶음에 기록
+void
+RtspServer::SendRtpPacket(Ptr<Session> session, Ptr<Packet> packet)
+{
+    RtpHeader rtp;
+    packet->PeekHeader(rtp);
+    NS_LOG_FUNCTION(this << session->id << rtp.GetSeq());
+
+    if(!session->sendHistory.empty())
+    {
+      SentPacket &sent = session->sendHistory[rtp.GetSeq() % session->sendHistory.size()];
+      if(sent.packet != 0)
+      {
+        session->historyBytes -= sent.packet->GetSize();
+      }
+      sent.packet = packet->Copy();
+      session->historyBytes += sent.packet->GetSize();
+      sent.seq = rtp.GetSeq();
+      sent.sent = Simulator::Now();
+    }
+    m_rtpSocket->SendTo(packet, 0, session->rtpAddress);
+    if(m_statsCollector != 0)
+    {
+      m_statsCollector->AddPacket(session->statsSlot, packet->GetSize());
+    }
+
+    if(session->fecGroupSize > 0)
+    {
+      AddToFecGroup(session, packet, rtp);
+    }
+}
+
+//RTP 패킷을 현재 FEC 묶음에 XOR하고, 묶음이 차거나 프레임이 끝나면 FEC 패킷 전송
+void
+RtspServer::AddToFecGroup(Ptr<Session> session, Ptr<Packet> packet, const RtpHeader &rtp)
+{
+    NS_LOG_FUNCTION(this << session->id << rtp.GetSeq());
+
+    const uint32_t headerSize = rtp.GetSerializedSize();
+    const uint32_t payloadSize = packet->GetSize() - headerSize;
+    if(session->fecCount == 0)
+    {
+      session->fecBaseSeq = rtp.GetSeq();
+      session->fecLength = 0;
+      session->fecMaxLength = 0;
+      session->fecHeader.assign(headerSize, 0);
+    }
+
+    uint8_t header[64];
+    NS_ASSERT(headerSize <= sizeof(header));
+    packet->CopyData(header, headerSize);
+    for(uint32_t idx = 0; idx < headerSize; idx++)
+    {
+      session->fecHeader[idx] ^= header[idx];
+    }
+    session->fecLength ^= payloadSize;
+    session->fecMaxLength = std::max(session->fecMaxLength, payloadSize);
+    session->fecCount++;
+
+    if(session->fecCount < session->fecGroupSize && !rtp.GetMarker())
+    {
+      return;
+    }
+
+    //페이로드는 모두 0으로 채워져 있으므로 XOR 결과도 0, 가장 긴 페이로드 길이만큼 보냄
+    RtpFecHeader fec;
+    fec.SetBaseSeq(session->fecBaseSeq);
+    fec.SetCount(session->fecCount);
+    fec.SetLengthRecovery(session->fecLength);
+    fec.SetHeaderRecovery(session->fecHeader);
+
+    RtpHeader fecRtp;
+    fecRtp.SetPayloadType(RtpFecHeader::PAYLOAD_TYPE);
+    fecRtp.SetSeq(session->fecSeq++);
+    fecRtp.SetFrameId(rtp.GetFrameId());
+
+    Ptr<Packet> fecPacket = m_packetPool.Create(session->fecMaxLength);
+    fecPacket->AddHeader(fec);
+    fecPacket->AddHeader(fecRtp);
+    NS_LOG_LOGIC("Server Rtp FEC: " << fec << " to session " << session->id);
+    session->fecCount = 0;
+
+    //PACED 모드에서는 방금 보낸 패킷 바로 다음 순서로 대기열에 넣어 token bucket을 거치게 함
+    if(m_pacingMode == PACED)
+    {
+      session->paceQueue.push_front(fecPacket);
+      session->paceQueueBytes += fecPacket->GetSize();
+    }
+    else
+    {
+      SendFecPacket(session, fecPacket);
+    }
+}
+
+//FEC 패킷 전송, send history와 FEC 묶음에는 기록하지 않음
+void
+RtspServer::SendFecPacket(Ptr<Session> session, Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << session->id);
+
+    m_fecTrace(packet);
+    m_rtpSocket->SendTo(packet, 0, session->rtpAddress);
+    if(m_statsCollector != 0)
+    {
+      m_statsCollector->AddPacket(session->statsSlot, packet->GetSize());
+    }
+}
+
+//보고된 loss 비율로 FEC 묶음 크기 결정 (오버헤드 1/k ≈ 배율 * loss)
+void
+RtspServer::UpdateFecGroupSize(Ptr<Session> session, double fractionLost)
+{
+    NS_LOG_FUNCTION(this << session->id << fractionLost);
+
+    uint32_t groupSize = 0;
+    double overhead = m_fecOverheadFactor * fractionLost;
+    if(overhead * m_maxFecGroupSize >= 1)
+    {
+      groupSize = std::max<uint32_t>(2, std::min<uint32_t>(m_maxFecGroupSize, uint32_t(1 / overhead)));
+    }
+    if(groupSize != session->fecGroupSize)
+    {
+      NS_LOG_INFO("Session " << session->id << " FEC group size " << session->fecGroupSize << " -> " << groupSize);
+      session->fecGroupSize = groupSize;
+      session->fecCount = 0;
+    }
+}
+
+//token bucket으로 대기 중인 RTP 패킷을 paceRate에 맞추어 전송
+void
+RtspServer::PaceRtpSend(Ptr<Session> session)
+{
+    NS_LOG_FUNCTION(this << session->id);
+
+    //bucket 크기는 패킷 하나(MTU)로 제한하여 burst를 막음
+    Time now = Simulator::Now();
+    session->paceTokens = std::min<double>(m_mtu,
+        session->paceTokens + (now - session->paceLastRefill).GetSeconds() * session->paceRate);
+    session->paceLastRefill = now;
+    //대기열의 패킷은 모두 MTU 이하이므로 bucket이 가득 차면 항상 하나는 보낼 수 있음
+    NS_ASSERT_MSG(session->paceQueue.empty() || session->paceQueue.front()->GetSize() <= m_mtu,
+                  "Paced RTP packet larger than the token bucket");
+
+    while(!session->paceQueue.empty()
+          && session->paceTokens >= session->paceQueue.front()->GetSize())
+    {
+      Ptr<Packet> packet = session->paceQueue.front();
+      session->paceQueue.pop_front();
+      session->paceQueueBytes -= packet->GetSize();
+      session->paceTokens -= packet->GetSize();
+
+      RtpHeader rtp;
+      packet->PeekHeader(rtp);
+      if(rtp.GetPayloadType() == RtpFecHeader::PAYLOAD_TYPE)
+      {
+        SendFecPacket(session, packet);
+      }
+      else
+      {
+        SendRtpPacket(session, packet);
+      }
+    }
+
+    if(!session->paceQueue.empty())
+    {
+      double deficit = session->paceQueue.front()->GetSize() - session->paceTokens;
+      session->paceEvent = Simulator::Schedule(Seconds(deficit / session->paceRate),
+                                               &RtspServer::PaceRtpSend, this, session);
+    }
 }
    
 
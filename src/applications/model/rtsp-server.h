@@ -4,6 +4,29 @@
 
 IPv6는 지원하지 않습니다.
 
+SETUP URL에 트레이스 파일 여러 개를 콤마로 나누어 주면 (예: "low.txt,mid.txt,high.txt")
+각 파일을 같은 영상의 서로 다른 비트레이트 representation으로 사용합니다.
+서버는 SwitchingInterval 프레임마다(GOP 경계) 전송률 제어의 목표 비트레이트를 넘지 않는
+가장 높은 representation으로 바꾸어 전송합니다.
+트레이스가 하나뿐이면 기존처럼 프레임 크기를 congestion level로 나누어 전송합니다.
+트레이스에 프레임 타입이 있으면 I 프레임 위치를 switching point로 사용하고
+(모든 representation의 GOP 구조가 같다고 가정)
+FrameDropPolicy에 따라 congestion 시 B 프레임을 보내지 않습니다.
+
+보낸 RTP 패킷은 세션 별 send history(SendHistorySize 개)에 보관하고,
+클라이언트가 RTCP NACK을 보내면 첫 전송 이후 RetransmissionDeadline이 지나지 않은 패킷만 재전송합니다.
+
+FecGroupSize가 0이 아니면 RTP 패킷 FecGroupSize개(또는 프레임 끝까지)마다 XOR FEC 패킷을 하나 보냅니다.
+AdaptiveFec를 켜면 RTCP로 보고된 loss 비율에 맞추어 묶음 크기를 조절합니다.
+
+MulticastGroup이 설정되어 있고 클라이언트가 SETUP Transport에 multicast를 요청하면
+같은 URL을 보는 모든 클라이언트가 multicast 스트림 하나를 공유합니다.
+스트림은 RTSP 연결이 없는 Session으로 표현되며, 그룹 주소:MulticastRtpPort로 한 번만 전송합니다.
+스트림은 PLAYING 상태인 시청자가 있을 때만 전송하고 (live, 중간에 들어온 시청자는 현재 프레임부터 받음)
+모든 시청자의 RTCP 보고와 NACK이 스트림의 전송률 제어와 재전송에 반영됩니다.
+재전송 패킷은 그룹이 아니라 NACK을 보낸 시청자에게만 unicast로 보냅니다.
+시청자 세션은 자신의 전송 타이머를 두지 않으므로 타이머는 스트림 수에만 비례합니다.
+
 */
 
 #ifndef RTSP_SERVER_H
@@ -16,11 +39,22 @@ IPv6는 지원하지 않습니다.
 #include <ns3/three-gpp-http-header.h>
 #include <ns3/application.h>
 #include <ns3/address.h>
+#include <ns3/ipv4-address.h>
 #include <ns3/traced-callback.h>
 #include <ns3/socket.h>
+#include <ns3/rtsp-frame-trace.h>
+#include <ns3/rtsp-header.h>
+#include <ns3/rtsp-rate-controller.h>
+#include <ns3/rtsp-stats-collector.h>
+#include <ns3/rtsp-tick-driver.h>
+#include <ns3/rtsp-memory-usage.h>
+#include <ns3/rtp-packet-pool.h>
+#include <ns3/rtp-header.h>
 #include <ostream>
-#include <fstream>
+#include <string>
 #include <vector>
+#include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -40,6 +74,45 @@ public:
         MODIFY,
     };
 
+    enum PacingMode_t
+    {
+        //RTP 패킷 전송 방식
+        BURST,                              //프레임의 모든 패킷을 한 번에 전송
+        PACED,                              //프레임 간격에 나누어 전송 (token bucket)
+    };
+
+    enum FrameDropPolicy_t
+    {
+        //congestion 시 프레임 선택 전송 방식
+        DROP_NONE,                          //모든 프레임 전송
+        DROP_B_FRAMES,                      //FrameDropLevel 이상에서 B 프레임(비참조) 생략
+    };
+
+    enum MemoryLimitPolicy_t
+    {
+        //세션 메모리가 SessionMemoryLimit을 넘었을 때의 처리
+        EVICT_OLDEST,                       //오래된 send history부터, 그 다음 pacing 대기 패킷을 버림
+        CLOSE_SESSION,                      //세션 종료 (multicast 스트림은 EVICT_OLDEST로 처리)
+    };
+
+    uint32_t GetSessionCount() const;
+    uint32_t GetMulticastStreamCount() const;
+
+    //메모리 사용량, 세션이 없으면 모두 0
+    RtspMemoryUsage GetSessionMemoryUsage(uint32_t sessionId) const;
+    //모든 세션과 multicast 스트림의 합
+    RtspMemoryUsage GetMemoryUsage() const;
+    //메모리 상한 때문에 버린 바이트
+    uint64_t GetMemoryEvictedBytes() const;
+    //RTP/FEC 페이로드 패킷 풀 (재사용 통계)
+    const RtpPacketPool &GetPacketPool() const;
+
+    //representation 변경 트레이스 (세션 ID, 새 representation 번호)
+    typedef void (* RepresentationTracedCallback)(uint32_t sessionId, uint32_t representation);
+    //프레임 트레이스 (세션 ID, 프레임 번호, 프레임 크기)
+    typedef void (* FrameTracedCallback)(uint32_t sessionId, uint32_t frameId, uint32_t frameSize);
+    //메모리 상한 트레이스 (세션 ID, 버리거나 세션 종료로 해제된 바이트)
+    typedef void (* MemoryEvictionTracedCallback)(uint32_t sessionId, uint64_t bytes);
 private:
     /**************************************************
     *                   소켓 콜백
@@ -48,11 +121,77 @@ private:
     void NewConnectionCreatedCallback (Ptr<Socket> socket, const Address &address);
     //Handle RTSP Request
     void HandleRtspReceive (Ptr<Socket> socket);
+    //Handle RTSP connection close
+    void HandleRtspClose (Ptr<Socket> socket);
     //Send RTSP Response
     void SendCallback (Ptr<Socket> socket, uint32_t availableBufferSize);
     //Handle RTCP Request
     void HandleRtcpReceive (Ptr<Socket> socket);
 
+    /**************************************************
+    *                   세션 상태
+    ***************************************************/
+    // 재전송을 위해 보관하는 RTP 패킷
+    struct SentPacket
+    {
+      Ptr<Packet>     packet;               //보낸 RTP 패킷 (헤더 포함)
+      uint32_t        seq;                  //RTP 시퀀스
+      Time            sent;                 //첫 전송 시각
+    };
+
+    // 클라이언트 하나(RTSP 연결 하나)에 해당하는 상태
+    class Session : public SimpleRefCount<Session>
+    {
+    public:
+      uint32_t        id;                   //세션 ID
+      std::string     url;                  //SETUP URL
+      Ptr<Socket>     rtspSocket;           //RTSP 연결 소켓
+      Ptr<Packet>     rtspRxBuffer;         //RTSP 수신 버퍼 (메시지 단위로 나누기 전)
+      Address         rtpAddress;           //클라이언트 RTP 주소
+      Address         rtcpAddress;          //클라이언트 RTCP 주소
+      State_t         state;                //세션 상태
+      std::vector<Ptr<RtspFrameTrace> > representations;  //비트레이트 오름차순 트레이스 (공유)
+      std::vector<double> representationRates;          //representation 별 비트레이트 (bps)
+      uint32_t        representation;       //현재 전송 중인 representation 번호
+      Ptr<RtspFrameTrace> trace;            //현재 representation의 트레이스
+      uint32_t        frameCount;           //모든 representation에 공통인 프레임 수
+      uint32_t        frameIndex;           //다음에 전송할 프레임 번호
+      uint32_t        seqNum;               //현재 전송된 시퀀스 넘버
+      Ptr<RtspRateController> rateController;  //세션 별 전송률 제어
+      double          maxRate;              //가장 높은 representation의 비트레이트 (bps)
+      double          congestionLevel;      //원본 대비 축소 비율 (maxRate / 목표 비트레이트)
+      Time            rtt;                  //RTCP로 계산한 RTT
+      Time            jitter;               //RTCP로 보고된 jitter
+      Time            oneWayDelay;          //RTCP로 보고된 평균 one-way delay
+      EventId         sendEvent;            //RTP 전송 타이머 이벤트
+
+      std::deque<Ptr<Packet> > paceQueue;   //pacing 대기 중인 RTP 패킷
+      uint32_t        paceQueueBytes;       //pacing 대기 중인 바이트
+      double          paceRate;             //pacing 속도 (bytes/s)
+      double          paceTokens;           //token bucket에 남은 바이트
+      Time            paceLastRefill;       //token을 마지막으로 채운 시각
+      EventId         paceEvent;            //pacing 전송 이벤트
+
+      std::vector<SentPacket> sendHistory;  //재전송용 send history (seq % 크기로 인덱싱), NACK을 쓰지 않으면 비어 있음
+      uint64_t        historyBytes;         //send history에 보관 중인 패킷 바이트
+      uint32_t        historyTail;          //send history에 남아 있을 수 있는 가장 오래된 시퀀스
+
+      uint32_t        fecGroupSize;         //FEC 묶음 크기, 0이면 FEC를 보내지 않음
+      uint32_t        fecSeq;               //다음 FEC 패킷 시퀀스 (미디어와 별도)
+      uint32_t        fecBaseSeq;           //현재 묶음의 첫 RTP 시퀀스
+      uint32_t        fecCount;             //현재 묶음에 들어간 RTP 패킷 수
+      uint16_t        fecLength;            //현재 묶음 페이로드 길이의 XOR
+      uint32_t        fecMaxLength;         //현재 묶음의 가장 긴 페이로드
+      std::vector<uint8_t> fecHeader;       //현재 묶음 RtpHeader 바이트의 XOR
+
+      Ptr<Session>    stream;               //시청 중인 multicast 스트림, unicast면 0
+      uint32_t        subscribers;          //multicast 스트림: SETUP한 클라이언트 수
+      uint32_t        viewers;              //multicast 스트림: PLAYING 중인 클라이언트 수
+
+      uint32_t        statsSlot;            //통계 수집기에 등록된 슬롯
+      uint32_t        tickIndex;            //공유 tick 세션 배열에서의 위치, 없으면 RtspTickDriver::INVALID
+    };
+
     /**************************************************
     *                    메소드
     ***************************************************/
@@ -60,8 +199,31 @@ private:
     virtual void StartApplication();
     virtual void StopApplication();
 
-    void ScheduleRtpSend();
-    void OpenFileStream();
+    Ptr<Session> CreateSession();
+    void HandleRtspRequest(Ptr<Session> session, const RtspHeader &request);
+    bool SetupStream(Ptr<Session> session, const std::string &url);
+    Ptr<Session> GetMulticastStream(const std::string &url);
+    void Unsubscribe(Ptr<Session> session);
+    void CloseStream(Ptr<Session> stream);
+    void ScheduleRtpSend(Ptr<Session> session);
+    void StartSendTimer(Ptr<Session> session);
+    void StopSendTimer(Ptr<Session> session);
+    void SendTick();
+    void SendFrame(Ptr<Session> session, uint32_t frameId, uint32_t frameSize);
+    void UpdateCongestionLevel(Ptr<Session> session);
+    bool LoadRepresentations(Ptr<Session> session, const std::string &url);
+    void SelectRepresentation(Ptr<Session> session);
+    void PaceRtpSend(Ptr<Session> session);
+    void SendRtpPacket(Ptr<Session> session, Ptr<Packet> packet);
+    void AddToFecGroup(Ptr<Session> session, Ptr<Packet> packet, const RtpHeader &rtp);
+    void SendFecPacket(Ptr<Session> session, Ptr<Packet> packet);
+    void UpdateFecGroupSize(Ptr<Session> session, double fractionLost);
+    void HandleReceiverReport(Ptr<Session> session, Ptr<Packet> packet);
+    void HandleNack(Ptr<Session> session, Ptr<Packet> packet, const Address &repairAddress);
+    bool EnableSendHistory(Ptr<Session> session);
+    void CloseSession(Ptr<Session> session);
+    RtspMemoryUsage GetSessionMemoryUsage(Ptr<Session> session) const;
+    bool EnforceMemoryLimit(Ptr<Session> session);
 
     /**************************************************
     *                      변수
@@ -71,41 +233,66 @@ private:
     Ptr<Socket> m_rtcpSocket;
     
     Address     m_localAddress;             //서버 IP 주소
-    Address     m_clientAddress;            //클라이언트 IP 주소
     uint16_t    m_rtpPort;                  //RTP 소켓 포트
     uint16_t    m_rtcpPort;                 //RTCP 소켓 포트
     uint16_t    m_rtspPort;                 //RTSP 소켓 포트
     
-    std::vector<int> m_frameSizes;          //전송 frame Size 배열
-    int m_count;                            //전송할 총 packet 개수
-
-    std::string m_fileName;                 //전송 파일 이름
-    std::ifstream m_fileStream;             //전송 파일 스트림
-    
     //RTSP variables
     //----------------
-    uint32_t m_seqNum;                      //현재 전송된 시퀀스 넘버
-    State_t m_state = INIT;                 //현재 서버 상태
-                                            //서버 상태에 따라서 전송 / 전송 중지
+    std::map<Ptr<Socket>, Ptr<Session> > m_sessions;    //RTSP 소켓 별 세션
+    std::map<Address, Ptr<Session> > m_rtcpSessions;    //클라이언트 RTCP 주소 별 세션
+    uint32_t m_nextSessionId;               //다음에 할당할 세션 ID
+    std::map<std::string, Ptr<Session> > m_multicastStreams; //URL 별 multicast 스트림
+    Ipv4Address m_multicastGroup;           //첫 multicast 그룹 주소, Any면 multicast 사용 안 함
+    uint16_t    m_multicastRtpPort;         //multicast RTP 포트
+    uint32_t    m_nextMulticastGroup;       //다음 스트림에 할당할 그룹 주소 오프셋
     
     const static int FRAME_PERIOD = 32;     // 프레임 간격 (1초 / 동영상의 프레임 레이트)
 
     //RTCP variables
     //----------------
-    const double MAX_CONGESTION_LEVEL = 16;
-    const double MIN_CONGESTION_LEVEL = 1;
-    double m_congestionLevel;               //congestion이 있을 경우 영상 압축하여 프레임 축소
-                                            //여기에서는 프레임 전송 바이트에 해당 변수를 나누는 식
-    double m_congestionThreshold;           //로스가 일어난 최소 레벨 기록 후에 그 레벨을 못넘게함
-    bool m_useCongestionThreshold;          //컨제스쳔 기준을 설정할지 말지
-    int32_t m_upscale;
+                                            //congestion이 있을 경우 영상 압축하여 프레임 축소
+                                            //여기에서는 프레임 전송 바이트에 congestion level을 나누는 식
+    TypeId m_rateControllerType;            //세션 별로 생성할 전송률 제어 타입
+    bool m_useCongestionThreshold;          //컨제스쳔 기준을 설정할지 말지 (RtspLevelRateController)
 
     //RTP variables
     //----------------
-    EventId         m_sendEvent;            //RTP 전송 타이머 이벤트
     uint64_t        m_sendDelay;            //RTP 패킷 전송 딜레이
+    uint32_t        m_mtu;                  //RTP 패킷 분할 기준 MTU
+    RtpPacketPool   m_packetPool;           //RTP/FEC 페이로드 패킷 풀
+    uint32_t        m_packetPoolSize;       //패킷 풀에 보관하는 페이로드 크기 수 (0이면 사용 안 함, 기본값)
+    PacingMode_t    m_pacingMode;           //RTP 전송 방식
+    double          m_pacingGain;           //pacing 속도 배율 (프레임 간격 대비)
+    uint32_t        m_switchingInterval;    //representation을 바꿀 수 있는 프레임 간격 (타입 정보가 없는 트레이스)
+    FrameDropPolicy_t m_frameDropPolicy;    //congestion 시 프레임 생략 방식
+    double          m_frameDropLevel;       //프레임 생략을 시작하는 congestion level
+    uint32_t        m_sendHistorySize;      //재전송용으로 보관하는 RTP 패킷 수 (0이면 재전송하지 않음)
+    Time            m_retransmissionDeadline; //첫 전송 후 재전송할 수 있는 최대 시간
+    uint32_t        m_fecGroupSize;         //FEC 묶음 크기 (고정), 0이면 FEC 없음
+    bool            m_adaptiveFec;          //loss 비율에 따라 FEC 묶음 크기 조절
+    double          m_fecOverheadFactor;    //loss 비율 대비 FEC 오버헤드 배율
+    uint32_t        m_maxFecGroupSize;      //adaptive FEC의 최대 묶음 크기
+
+    uint64_t        m_sessionMemoryLimit;   //세션 별 메모리 상한 (바이트), 0이면 제한 없음
+    MemoryLimitPolicy_t m_memoryLimitPolicy; //상한을 넘었을 때의 처리
+    uint64_t        m_memoryEvictedBytes;   //상한 때문에 버린 바이트
+
+    Ptr<RtspStatsCollector> m_statsCollector; //세션 별 통계 수집기, 없으면 0
+    Ptr<RtspTickDriver> m_tickDriver;       //세션 공유 RTP 전송 tick, 없으면 세션마다 이벤트
+    uint32_t        m_tickMember;           //드라이버에 등록된 서버의 멤버 ID
+    std::vector<Ptr<Session> > m_tickSessions; //tick마다 전송할 세션 (밀집 배열)
+    bool            m_ticking;              //SendTick 처리 중 여부
+    bool            m_tickDirty;            //tick 도중 빠진 세션이 있는지 여부
+
+    const static uint32_t IPV4_UDP_HEADER_SIZE = 20 + 8;
 
     ns3::TracedCallback<double &> m_congestionLevelTrace; // trace callback
+    ns3::TracedCallback<uint32_t, uint32_t> m_representationTrace; // 세션 ID, 바뀐 representation
+    ns3::TracedCallback<uint32_t, uint32_t, uint32_t> m_frameDropTrace; // 생략한 프레임
+    ns3::TracedCallback<Ptr<const Packet> > m_retransmitTrace;        // 재전송한 RTP 패킷
+    ns3::TracedCallback<Ptr<const Packet> > m_fecTrace;               // 보낸 FEC 패킷
+    ns3::TracedCallback<uint32_t, uint64_t> m_memoryEvictionTrace;    // 메모리 상한으로 해제된 바이트
 };
 
 }
@@ -0,0 +1,256 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-stats-collector.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/enum.h>
+
+NS_LOG_COMPONENT_DEFINE("RtspStatsCollector");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RtspStatsCollector);
+
+const char RtspStatsCollector::MAGIC[8] = { 'R', 'T', 'S', 'P', 'S', 'T', 'A', '1' };
+
+TypeId
+RtspStatsCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspStatsCollector")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspStatsCollector> ()
+    .AddAttribute ("Interval",
+                   "Sampling period of all registered sessions.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&RtspStatsCollector::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("FileName",
+                   "Output file of the samples; empty keeps the counters in memory only.",
+                   StringValue ("rtsp-stats.csv"),
+                   MakeStringAccessor (&RtspStatsCollector::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Format",
+                   "Output format of the samples.",
+                   EnumValue (RtspStatsCollector::CSV),
+                   MakeEnumAccessor (&RtspStatsCollector::m_format),
+                   MakeEnumChecker (RtspStatsCollector::CSV, "Csv",
+                                    RtspStatsCollector::BINARY, "Binary"))
+  ;
+  return tid;
+}
+
+RtspStatsCollector::RtspStatsCollector ()
+  : m_interval (MilliSeconds (100)),
+    m_fileName ("rtsp-stats.csv"),
+    m_format (CSV),
+    m_opened (false),
+    m_activeCount (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RtspStatsCollector::~RtspStatsCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspStatsCollector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Simulator::Cancel (m_sampleEvent);
+  if (m_opened)
+    {
+      m_out.close ();
+      m_opened = false;
+    }
+  Object::DoDispose ();
+}
+
+uint32_t
+RtspStatsCollector::Register (Role_t role, uint32_t nodeId, uint32_t sessionId)
+{
+  uint32_t slot = m_role.size ();
+  NS_LOG_FUNCTION (this << role << nodeId << sessionId << slot);
+
+  m_role.push_back (role);
+  m_active.push_back (1);
+  m_node.push_back (nodeId);
+  m_session.push_back (sessionId);
+  m_bytes.push_back (0);
+  m_packets.push_back (0);
+  m_losses.push_back (0);
+  m_stalls.push_back (0);
+  m_congestionLevel.push_back (1);
+
+  if (m_activeCount++ == 0 && !m_sampleEvent.IsRunning ())
+    {
+      m_sampleEvent = Simulator::Schedule (m_interval, &RtspStatsCollector::Sample, this);
+    }
+  return slot;
+}
+
+void
+RtspStatsCollector::Unregister (uint32_t slot)
+{
+  if (slot >= m_active.size () || !m_active[slot])
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << slot);
+
+  Open ();
+  Write (slot, Simulator::Now ().GetSeconds ());
+  m_active[slot] = 0;
+
+  //활성 슬롯이 없으면 이벤트를 남기지 않음 (시뮬레이션 종료를 막지 않도록)
+  if (--m_activeCount == 0)
+    {
+      Simulator::Cancel (m_sampleEvent);
+    }
+}
+
+void
+RtspStatsCollector::SetSession (uint32_t slot, uint32_t sessionId)
+{
+  NS_ASSERT (slot < m_session.size ());
+  m_session[slot] = sessionId;
+}
+
+uint32_t
+RtspStatsCollector::GetSlotCount (void) const
+{
+  return m_role.size ();
+}
+
+uint32_t
+RtspStatsCollector::GetActiveCount (void) const
+{
+  return m_activeCount;
+}
+
+uint64_t
+RtspStatsCollector::GetBytes (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_bytes.size ());
+  return m_bytes[slot];
+}
+
+uint64_t
+RtspStatsCollector::GetPackets (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_packets.size ());
+  return m_packets[slot];
+}
+
+uint64_t
+RtspStatsCollector::GetLosses (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_losses.size ());
+  return m_losses[slot];
+}
+
+uint32_t
+RtspStatsCollector::GetStalls (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_stalls.size ());
+  return m_stalls[slot];
+}
+
+double
+RtspStatsCollector::GetCongestionLevel (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_congestionLevel.size ());
+  return m_congestionLevel[slot];
+}
+
+void
+RtspStatsCollector::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Open ();
+  double now = Simulator::Now ().GetSeconds ();
+  const uint32_t count = m_active.size ();
+  for (uint32_t slot = 0; slot < count; slot++)
+    {
+      if (m_active[slot])
+        {
+          Write (slot, now);
+        }
+    }
+
+  Simulator::Cancel (m_sampleEvent);
+  if (m_activeCount > 0)
+    {
+      m_sampleEvent = Simulator::Schedule (m_interval, &RtspStatsCollector::Sample, this);
+    }
+}
+
+//출력 파일은 첫 샘플에서 열어서 속성 설정이 끝난 뒤의 파일 이름을 사용
+void
+RtspStatsCollector::Open (void)
+{
+  if (m_opened || m_fileName.empty ())
+    {
+      return;
+    }
+
+  std::ios::openmode mode = std::ios::out | std::ios::trunc;
+  if (m_format == BINARY)
+    {
+      mode |= std::ios::binary;
+    }
+  m_out.open (m_fileName.c_str (), mode);
+  if (!m_out.is_open ())
+    {
+      NS_LOG_ERROR ("Failed to open " << m_fileName);
+      m_fileName.clear ();
+      return;
+    }
+  m_opened = true;
+
+  if (m_format == BINARY)
+    {
+      m_out.write (MAGIC, sizeof (MAGIC));
+    }
+  else
+    {
+      m_out << "time,slot,role,node,session,bytes,packets,losses,stalls,congestion\n";
+    }
+}
+
+void
+RtspStatsCollector::Write (uint32_t slot, double now)
+{
+  if (!m_opened)
+    {
+      return;
+    }
+
+  if (m_format == BINARY)
+    {
+      m_out.write ((const char *) &now, sizeof (now));
+      m_out.write ((const char *) &slot, sizeof (slot));
+      m_out.write ((const char *) &m_role[slot], sizeof (uint8_t));
+      m_out.write ((const char *) &m_node[slot], sizeof (uint32_t));
+      m_out.write ((const char *) &m_session[slot], sizeof (uint32_t));
+      m_out.write ((const char *) &m_bytes[slot], sizeof (uint64_t));
+      m_out.write ((const char *) &m_packets[slot], sizeof (uint64_t));
+      m_out.write ((const char *) &m_losses[slot], sizeof (uint64_t));
+      m_out.write ((const char *) &m_stalls[slot], sizeof (uint32_t));
+      m_out.write ((const char *) &m_congestionLevel[slot], sizeof (double));
+    }
+  else
+    {
+      m_out << now << ',' << slot << ',' << (m_role[slot] == CLIENT ? "client" : "server")
+            << ',' << m_node[slot] << ',' << m_session[slot]
+            << ',' << m_bytes[slot] << ',' << m_packets[slot] << ',' << m_losses[slot]
+            << ',' << m_stalls[slot] << ',' << m_congestionLevel[slot] << '\n';
+    }
+}
+
+}
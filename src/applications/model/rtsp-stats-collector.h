@@ -0,0 +1,149 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 통계 수집기
+
+RtspClient/RtspServer의 "StatsCollector" 속성에 같은 수집기를 지정하면
+클라이언트와 서버 세션마다 슬롯이 하나씩 등록되고, 각 애플리케이션은
+자기 슬롯의 카운터만 갱신합니다.
+
+- 카운터는 슬롯 번호로 인덱싱되는 배열 (struct-of-arrays)
+  갱신은 배열 원소 하나를 더하는 것뿐이므로 세션이 수천 개여도 부담이 적음
+- 수집기 하나당 주기 이벤트 하나로 활성 슬롯 전체를 샘플링
+- 카운터는 누적값, 구간 값은 후처리에서 차이로 계산
+- 슬롯은 재사용하지 않으므로 슬롯 번호로 세션을 구분할 수 있음
+
+출력 형식
+- CSV    : time,slot,role,node,session,bytes,packets,losses,stalls,congestion
+- BINARY : MAGIC(8) 다음에 샘플 레코드 반복
+           time(double) | slot(4) | role(1) | node(4) | session(4)
+           | bytes(8) | packets(8) | losses(8) | stalls(4) | congestion(double)
+           (리틀 엔디언, 패딩 없음)
+
+*/
+
+#ifndef RTSP_STATS_COLLECTOR_H
+#define RTSP_STATS_COLLECTOR_H
+
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <ns3/assert.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class RtspStatsCollector : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspStatsCollector ();
+  virtual ~RtspStatsCollector ();
+
+  enum Role_t
+  {
+    CLIENT = 0,
+    SERVER = 1,
+  };
+
+  enum Format_t
+  {
+    CSV,
+    BINARY,
+  };
+
+  //슬롯 등록, 첫 슬롯이 등록되면 샘플링 시작
+  uint32_t Register (Role_t role, uint32_t nodeId, uint32_t sessionId);
+  //마지막 샘플을 기록하고 슬롯을 비활성화, 활성 슬롯이 없으면 샘플링 중지
+  void Unregister (uint32_t slot);
+  void SetSession (uint32_t slot, uint32_t sessionId);
+
+  //카운터 갱신
+  void AddPacket (uint32_t slot, uint32_t bytes);
+  void AddLoss (uint32_t slot, uint32_t lost);
+  void SetLoss (uint32_t slot, uint64_t lost);
+  void AddStall (uint32_t slot);
+  void SetCongestionLevel (uint32_t slot, double level);
+
+  uint32_t GetSlotCount (void) const;
+  uint32_t GetActiveCount (void) const;
+  uint64_t GetBytes (uint32_t slot) const;
+  uint64_t GetPackets (uint32_t slot) const;
+  uint64_t GetLosses (uint32_t slot) const;
+  uint32_t GetStalls (uint32_t slot) const;
+  double GetCongestionLevel (uint32_t slot) const;
+
+  //활성 슬롯 전체를 지금 기록
+  void Sample (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void Write (uint32_t slot, double now);
+  void Open (void);
+
+  static const char MAGIC[8];               //바이너리 파일 식별자
+
+  Time m_interval;                          //샘플링 주기
+  std::string m_fileName;                   //출력 파일, 비어 있으면 기록하지 않음
+  Format_t m_format;                        //출력 형식
+  std::ofstream m_out;                      //출력 스트림
+  bool m_opened;                            //출력 파일을 열었는지 여부
+  EventId m_sampleEvent;                    //샘플링 이벤트
+
+  //슬롯 별 카운터 (struct-of-arrays)
+  std::vector<uint8_t> m_role;              //Role_t
+  std::vector<uint8_t> m_active;            //등록 중인 슬롯
+  std::vector<uint32_t> m_node;             //노드 ID
+  std::vector<uint32_t> m_session;          //RTSP 세션 ID
+  std::vector<uint64_t> m_bytes;            //주고받은 RTP 바이트
+  std::vector<uint64_t> m_packets;          //주고받은 RTP 패킷 수
+  std::vector<uint64_t> m_losses;           //손실 RTP 패킷 수
+  std::vector<uint32_t> m_stalls;           //재생 stall 횟수
+  std::vector<double> m_congestionLevel;    //congestion level
+  uint32_t m_activeCount;                   //활성 슬롯 수
+};
+
+inline void
+RtspStatsCollector::AddPacket (uint32_t slot, uint32_t bytes)
+{
+  NS_ASSERT (slot < m_bytes.size ());
+  m_bytes[slot] += bytes;
+  m_packets[slot]++;
+}
+
+inline void
+RtspStatsCollector::AddLoss (uint32_t slot, uint32_t lost)
+{
+  NS_ASSERT (slot < m_losses.size ());
+  m_losses[slot] += lost;
+}
+
+inline void
+RtspStatsCollector::SetLoss (uint32_t slot, uint64_t lost)
+{
+  NS_ASSERT (slot < m_losses.size ());
+  m_losses[slot] = lost;
+}
+
+inline void
+RtspStatsCollector::AddStall (uint32_t slot)
+{
+  NS_ASSERT (slot < m_stalls.size ());
+  m_stalls[slot]++;
+}
+
+inline void
+RtspStatsCollector::SetCongestionLevel (uint32_t slot, double level)
+{
+  NS_ASSERT (slot < m_congestionLevel.size ());
+  m_congestionLevel[slot] = level;
+}
+
+}
+
+#endif
@@ -0,0 +1,208 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include "rtsp-tick-driver.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE("RtspTickDriver");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RtspTickDriver);
+
+const uint32_t RtspTickDriver::INVALID;
+
+TypeId
+RtspTickDriver::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtspTickDriver")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<RtspTickDriver> ()
+  ;
+  return tid;
+}
+
+RtspTickDriver::RtspTickDriver ()
+  : m_nextId (0),
+    m_ticks (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RtspTickDriver::~RtspTickDriver ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RtspTickDriver::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (auto &group : m_groups)
+    {
+      Simulator::Cancel (group.event);
+      group.members.clear ();
+    }
+  m_groups.clear ();
+  m_location.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+RtspTickDriver::Add (Time period, Callback<void> callback, Time delay)
+{
+  NS_LOG_FUNCTION (this << period << delay);
+  NS_ASSERT (period.IsStrictlyPositive ());
+
+  uint32_t index = 0;
+  while (index < m_groups.size () && m_groups[index].period != period)
+    {
+      index++;
+    }
+  if (index == m_groups.size ())
+    {
+      Group group;
+      group.period = period;
+      group.iterating = false;
+      group.dirty = false;
+      m_groups.push_back (group);
+    }
+
+  Group &group = m_groups[index];
+  Member member;
+  member.callback = callback;
+  member.start = Simulator::Now () + delay;
+  member.id = m_nextId++;
+  m_location[member.id] = std::make_pair (index, (uint32_t) group.members.size ());
+  group.members.push_back (member);
+
+  if (!group.event.IsRunning () && !group.iterating)
+    {
+      ScheduleTick (index);
+    }
+  return member.id;
+}
+
+void
+RtspTickDriver::Remove (uint32_t id)
+{
+  auto it = m_location.find (id);
+  if (it == m_location.end ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << id);
+
+  uint32_t index = it->second.first;
+  uint32_t position = it->second.second;
+  m_location.erase (it);
+
+  Group &group = m_groups[index];
+  if (group.iterating)
+    {
+      //tick 도중에는 배열 위치를 바꾸지 않음
+      group.members[position].callback.Nullify ();
+      group.dirty = true;
+      return;
+    }
+
+  //마지막 원소와 교환해서 제거
+  if (position + 1 != group.members.size ())
+    {
+      group.members[position] = group.members.back ();
+      m_location[group.members[position].id].second = position;
+    }
+  group.members.pop_back ();
+  if (group.members.empty ())
+    {
+      Simulator::Cancel (group.event);
+    }
+}
+
+uint32_t
+RtspTickDriver::GetMemberCount (void) const
+{
+  return m_location.size ();
+}
+
+uint32_t
+RtspTickDriver::GetGroupCount (void) const
+{
+  return m_groups.size ();
+}
+
+uint64_t
+RtspTickDriver::GetTickCount (void) const
+{
+  return m_ticks;
+}
+
+//다음 주기의 정수배 시각에 tick 예약
+void
+RtspTickDriver::ScheduleTick (uint32_t index)
+{
+  Group &group = m_groups[index];
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  int64_t period = group.period.GetTimeStep ();
+  int64_t next = (now / period + 1) * period;
+  group.event = Simulator::Schedule (TimeStep (next - now), &RtspTickDriver::Tick, this, index);
+}
+
+void
+RtspTickDriver::Tick (uint32_t index)
+{
+  m_ticks++;
+  const Time now = Simulator::Now ();
+
+  //콜백 안에서 Add가 배열을 키울 수 있으므로 매번 인덱스로 접근하고 콜백은 복사해서 호출
+  //tick 도중 추가된 멤버는 tick 시작 시점의 개수 뒤에 붙으므로 delay와 관계없이 다음 tick부터 호출됨
+  m_groups[index].iterating = true;
+  const uint32_t count = m_groups[index].members.size ();
+  for (uint32_t i = 0; i < count; i++)
+    {
+      const Member &member = m_groups[index].members[i];
+      if (member.start > now || member.callback.IsNull ())
+        {
+          continue;
+        }
+      Callback<void> callback = member.callback;
+      callback ();
+    }
+  m_groups[index].iterating = false;
+
+  if (m_groups[index].dirty)
+    {
+      Compact (index);
+    }
+  if (!m_groups[index].members.empty ())
+    {
+      ScheduleTick (index);
+    }
+}
+
+//tick 도중 제거된 멤버를 배열에서 지움
+void
+RtspTickDriver::Compact (uint32_t index)
+{
+  Group &group = m_groups[index];
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < group.members.size (); i++)
+    {
+      if (group.members[i].callback.IsNull ())
+        {
+          continue;
+        }
+      if (count != i)
+        {
+          group.members[count] = group.members[i];
+        }
+      m_location[group.members[count].id].second = count;
+      count++;
+    }
+  group.members.resize (count);
+  group.dirty = false;
+}
+
+}
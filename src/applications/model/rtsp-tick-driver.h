@@ -0,0 +1,82 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 공유 tick 드라이버
+
+세션마다 주기 이벤트를 따로 예약하는 대신, 같은 주기의 세션을 하나의 그룹으로 묶어
+그룹마다 이벤트 하나가 tick마다 등록된 콜백 배열을 순서대로 호출합니다.
+RtspClient/RtspServer의 "TickDriver" 속성에 같은 드라이버를 지정하면 사용됩니다.
+
+- tick 시각은 주기의 정수배 (0, period, 2 * period, ...)
+  그래서 세션의 첫 호출은 Add 시점 + delay 이후의 첫 tick으로 맞춰짐
+- 콜백은 그룹 안에서 등록 순서와 무관한 밀집 배열로 보관 (제거는 마지막 원소와 교환)
+- tick 도중의 Remove는 콜백만 지우고 tick이 끝난 뒤 배열을 정리
+- 그룹이 비면 이벤트를 남기지 않음 (시뮬레이션 종료를 막지 않도록)
+
+*/
+
+#ifndef RTSP_TICK_DRIVER_H
+#define RTSP_TICK_DRIVER_H
+
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <ns3/callback.h>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class RtspTickDriver : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  RtspTickDriver ();
+  virtual ~RtspTickDriver ();
+
+  static const uint32_t INVALID = 0xffffffff;
+
+  //period마다 callback 호출, 지금부터 delay 이후의 첫 tick부터 호출됨
+  //Remove에 사용할 ID 반환
+  uint32_t Add (Time period, Callback<void> callback, Time delay = Time (0));
+  void Remove (uint32_t id);
+
+  uint32_t GetMemberCount (void) const;
+  uint32_t GetGroupCount (void) const;
+  //지금까지 실행된 tick 이벤트 수
+  uint64_t GetTickCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct Member
+  {
+    Callback<void> callback;    //tick마다 호출할 콜백, 제거되면 null
+    Time start;                 //첫 호출 가능 시각
+    uint32_t id;                //멤버 ID
+  };
+
+  struct Group
+  {
+    Time period;                //tick 주기
+    std::vector<Member> members;  //밀집 배열
+    EventId event;              //다음 tick 이벤트
+    bool iterating;             //tick 처리 중 여부
+    bool dirty;                 //tick 도중 제거된 멤버가 있는지 여부
+  };
+
+  void Tick (uint32_t group);
+  void ScheduleTick (uint32_t group);
+  void Compact (uint32_t group);
+
+  std::vector<Group> m_groups;                                //주기 별 그룹
+  std::map<uint32_t, std::pair<uint32_t, uint32_t> > m_location; //멤버 ID -> (그룹, 배열 위치)
+  uint32_t m_nextId;                                          //다음 멤버 ID
+  uint64_t m_ticks;                                           //실행된 tick 이벤트 수
+};
+
+}
+
+#endif
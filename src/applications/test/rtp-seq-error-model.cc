@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+#include <ns3/ppp-header.h>
+#include <ns3/ipv4-header.h>
+#include <ns3/udp-header.h>
+#include <ns3/rtp-header.h>
+#include "rtp-seq-error-model.h"
+
+namespace ns3 {
+
+TypeId
+RtpSeqErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtpSeqErrorModel")
+    .SetParent<ErrorModel> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<RtpSeqErrorModel> ()
+  ;
+  return tid;
+}
+
+RtpSeqErrorModel::RtpSeqErrorModel ()
+  : m_port (0),
+    m_seq (0),
+    m_dropped (0)
+{
+}
+
+void
+RtpSeqErrorModel::SetTarget (uint16_t port, uint32_t seq)
+{
+  m_port = port;
+  m_seq = seq;
+}
+
+uint32_t
+RtpSeqErrorModel::GetDropped (void) const
+{
+  return m_dropped;
+}
+
+bool
+RtpSeqErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  //point-to-point 수신 시점의 패킷: PPP | IPv4 | UDP | RTP
+  Ptr<Packet> packet = p->Copy ();
+  PppHeader ppp;
+  packet->RemoveHeader (ppp);
+  if (ppp.GetProtocol () != 0x0021)
+    {
+      return false;
+    }
+  Ipv4Header ip;
+  packet->RemoveHeader (ip);
+  if (ip.GetProtocol () != UdpHeader::PROT_NUMBER)
+    {
+      return false;
+    }
+  UdpHeader udp;
+  packet->RemoveHeader (udp);
+  if (udp.GetDestinationPort () != m_port)
+    {
+      return false;
+    }
+  RtpHeader rtp;
+  packet->PeekHeader (rtp);
+  if (rtp.GetPayloadType () == RtpFecHeader::PAYLOAD_TYPE || rtp.GetSeq () != m_seq || m_dropped > 0)
+    {
+      return false;
+    }
+  m_dropped++;
+  return true;
+}
+
+void
+RtpSeqErrorModel::DoReset (void)
+{
+  m_dropped = 0;
+}
+
+}
@@ -0,0 +1,39 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP 패킷 하나를 버리는 테스트용 ErrorModel
+
+FEC, NACK 복원 테스트에서 point-to-point 장치의 ReceiveErrorModel로 씁니다.
+
+*/
+
+#ifndef RTP_SEQ_ERROR_MODEL_H
+#define RTP_SEQ_ERROR_MODEL_H
+
+#include <ns3/error-model.h>
+
+namespace ns3 {
+
+//지정한 UDP 포트로 가는 RTP 미디어 패킷 중 시퀀스가 seq인 패킷 하나만 버림
+class RtpSeqErrorModel : public ErrorModel
+{
+public:
+  static TypeId GetTypeId (void);
+  RtpSeqErrorModel ();
+
+  void SetTarget (uint16_t port, uint32_t seq);
+  uint32_t GetDropped (void) const;
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  uint16_t m_port;
+  uint32_t m_seq;
+  uint32_t m_dropped;
+};
+
+}
+
+#endif
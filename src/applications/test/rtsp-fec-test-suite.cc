@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP XOR FEC 테스트
+
+point-to-point 링크로 연결된 RtspServer와 RtspClient 사이에서
+클라이언트로 가는 RTP 미디어 패킷 하나만 버리고, NACK 없이 FEC로 복원되는지 확인합니다.
+FEC 패킷도 MTU 안에 들어가야 하므로 PACED 모드에서도 같은 결과가 나와야 합니다.
+
+*/
+
+#include <fstream>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/pointer.h>
+#include <ns3/string.h>
+#include <ns3/enum.h>
+#include <ns3/internet-stack-helper.h>
+#include <ns3/ipv4-address-helper.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/rtsp-client-server-helper.h>
+#include "rtp-seq-error-model.h"
+
+using namespace ns3;
+
+class RtspFecRecoveryTestCase : public TestCase
+{
+public:
+  RtspFecRecoveryTestCase (RtspServer::PacingMode_t pacingMode);
+
+private:
+  virtual void DoRun (void);
+
+  RtspServer::PacingMode_t m_pacingMode;
+};
+
+RtspFecRecoveryTestCase::RtspFecRecoveryTestCase (RtspServer::PacingMode_t pacingMode)
+  : TestCase (pacingMode == RtspServer::PACED
+              ? "XOR FEC recovers a single lost RTP packet with paced sending"
+              : "XOR FEC recovers a single lost RTP packet with burst sending"),
+    m_pacingMode (pacingMode)
+{
+}
+
+void
+RtspFecRecoveryTestCase::DoRun (void)
+{
+  //프레임마다 RTP 패킷 여러 개로 나뉘도록 큰 프레임의 트레이스 생성
+  std::string fileName = CreateTempDirFilename ("rtsp-fec-trace.txt");
+  std::ofstream trace (fileName.c_str ());
+  for (uint32_t frame = 0; frame < 200; frame++)
+    {
+      trace << 64000 << std::endl;
+    }
+  trace.close ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  const uint16_t rtpPort = 5004;
+  //첫 FEC 묶음(seq 0~3)의 미디어 패킷 하나를 버림, FEC 패킷을 받기 전이라도 복원되어야 함
+  Ptr<RtpSeqErrorModel> errorModel = CreateObject<RtpSeqErrorModel> ();
+  errorModel->SetTarget (rtpPort, 1);
+  devices.Get (0)->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+
+  RtspServerHelper server (Address (interfaces.GetAddress (1)));
+  server.SetAttribute ("FecGroupSize", UintegerValue (4));
+  server.SetAttribute ("PacingMode", EnumValue (m_pacingMode));
+  ApplicationContainer apps = server.Install (nodes.Get (1));
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (3));
+
+  RtspClientHelper client (Address (interfaces.GetAddress (1)), Address (interfaces.GetAddress (0)));
+  client.SetAttribute ("FileName", StringValue (fileName));
+  client.SetAttribute ("RtpPort", UintegerValue (rtpPort));
+  apps = client.Install (nodes.Get (0));
+  client.ScheduleMessage (MilliSeconds (100), RtspClient::SETUP);
+  client.ScheduleMessage (MilliSeconds (200), RtspClient::PLAY);
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (3));
+
+  Ptr<RtspClient> rtspClient = DynamicCast<RtspClient> (apps.Get (0));
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (errorModel->GetDropped (), 1, "RTP packet was not dropped");
+  NS_TEST_EXPECT_MSG_EQ (rtspClient->GetFecRecoveredPackets (), 1, "Lost RTP packet not recovered by FEC");
+  NS_TEST_EXPECT_MSG_EQ (rtspClient->GetRecoveredPackets (), 0, "Packet recovered without NACK enabled");
+  //FEC 패킷이 MTU를 넘거나 pacing에서 멈추면 뒤쪽 프레임을 받지 못함
+  NS_TEST_EXPECT_MSG_GT (rtspClient->GetDecodedFrames (), 50, "Stream stalled");
+
+  Simulator::Destroy ();
+}
+
+class RtspFecTestSuite : public TestSuite
+{
+public:
+  RtspFecTestSuite ();
+};
+
+RtspFecTestSuite::RtspFecTestSuite ()
+  : TestSuite ("rtsp-fec", SYSTEM)
+{
+  AddTestCase (new RtspFecRecoveryTestCase (RtspServer::BURST), TestCase::QUICK);
+  AddTestCase (new RtspFecRecoveryTestCase (RtspServer::PACED), TestCase::QUICK);
+}
+
+static RtspFecTestSuite g_rtspFecTestSuite;
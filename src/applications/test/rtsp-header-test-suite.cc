@@ -0,0 +1,295 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP/RTCP/RTSP 헤더 테스트
+
+각 헤더를 패킷에 붙였다가 다시 떼어내서 모든 필드가 그대로 복원되는지 확인합니다.
+
+*/
+
+#include <ns3/test.h>
+#include <ns3/packet.h>
+#include <ns3/rtp-header.h>
+#include <ns3/rtcp-header.h>
+#include <ns3/rtsp-header.h>
+
+using namespace ns3;
+
+class RtpHeaderTestCase : public TestCase
+{
+public:
+  RtpHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtpHeaderTestCase::RtpHeaderTestCase ()
+  : TestCase ("RtpHeader serialize/deserialize round trip")
+{
+}
+
+void
+RtpHeaderTestCase::DoRun (void)
+{
+  RtpHeader header;
+  header.SetSeq (123456);
+  header.SetMarker (true);
+  header.SetPayloadType (96);
+  header.SetFrameId (4321);
+  header.SetFragmentIndex (3);
+  header.SetFragmentCount (7);
+  header.SetRepresentation (2);
+  header.SetFrameType (1);
+  header.SetReferenceDistance (5);
+
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 100 + header.GetSerializedSize (), "Wrong serialized size");
+
+  RtpHeader result;
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 100, "Payload changed");
+  NS_TEST_EXPECT_MSG_EQ (result.GetSeq (), 123456, "Wrong sequence");
+  NS_TEST_EXPECT_MSG_EQ (result.GetMarker (), true, "Wrong marker");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) result.GetPayloadType (), 96, "Wrong payload type");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFrameId (), 4321, "Wrong frame id");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFragmentIndex (), 3, "Wrong fragment index");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFragmentCount (), 7, "Wrong fragment count");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) result.GetRepresentation (), 2, "Wrong representation");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) result.GetFrameType (), 1, "Wrong frame type");
+  NS_TEST_EXPECT_MSG_EQ (result.GetReferenceDistance (), 5, "Wrong reference distance");
+}
+
+class RtpFecHeaderTestCase : public TestCase
+{
+public:
+  RtpFecHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtpFecHeaderTestCase::RtpFecHeaderTestCase ()
+  : TestCase ("RtpFecHeader serialize/deserialize round trip")
+{
+}
+
+void
+RtpFecHeaderTestCase::DoRun (void)
+{
+  RtpHeader rtp;
+  std::vector<uint8_t> recovery (rtp.GetSerializedSize ());
+  for (uint32_t idx = 0; idx < recovery.size (); idx++)
+    {
+      recovery[idx] = idx * 7 + 1;
+    }
+
+  RtpFecHeader header;
+  header.SetBaseSeq (1000);
+  header.SetCount (4);
+  header.SetLengthRecovery (0x1234);
+  header.SetHeaderRecovery (recovery);
+
+  Ptr<Packet> packet = Create<Packet> (50);
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 50 + header.GetSerializedSize (), "Wrong serialized size");
+
+  RtpFecHeader result;
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 50, "Payload changed");
+  NS_TEST_EXPECT_MSG_EQ (result.GetBaseSeq (), 1000, "Wrong base sequence");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) result.GetCount (), 4, "Wrong count");
+  NS_TEST_EXPECT_MSG_EQ (result.GetLengthRecovery (), 0x1234, "Wrong length recovery");
+  NS_TEST_EXPECT_MSG_EQ ((result.GetHeaderRecovery () == recovery), true, "Wrong header recovery");
+}
+
+class RtcpReceiverReportHeaderTestCase : public TestCase
+{
+public:
+  RtcpReceiverReportHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtcpReceiverReportHeaderTestCase::RtcpReceiverReportHeaderTestCase ()
+  : TestCase ("RtcpReceiverReportHeader serialize/deserialize round trip")
+{
+}
+
+void
+RtcpReceiverReportHeaderTestCase::DoRun (void)
+{
+  //1/256, 1/65536초 단위로 정확히 표현되는 값 사용
+  RtcpReceiverReportHeader header;
+  header.SetSenderSsrc (11);
+  header.SetSourceSsrc (22);
+  header.SetFractionLost (0.25);
+  header.SetCumulativeLost (-5);
+  header.SetHighestSeq (70000);
+  header.SetJitter (MicroSeconds (1234));
+  header.SetLastSr (Seconds (1.5));
+  header.SetDelaySinceLastSr (MilliSeconds (250));
+  header.SetOneWayDelay (MicroSeconds (20000));
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), header.GetSerializedSize (), "Wrong serialized size");
+
+  RtcpCommonHeader common;
+  packet->PeekHeader (common);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) common.GetPacketType (), (uint32_t) RtcpReceiverReportHeader::PT_RR,
+                         "Wrong packet type");
+  NS_TEST_EXPECT_MSG_EQ (common.GetPacketSize (), header.GetSerializedSize (), "Wrong RTCP length");
+
+  RtcpReceiverReportHeader result;
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (result.GetSenderSsrc (), 11, "Wrong sender SSRC");
+  NS_TEST_EXPECT_MSG_EQ (result.GetSourceSsrc (), 22, "Wrong source SSRC");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFractionLost (), 0.25, "Wrong fraction lost");
+  NS_TEST_EXPECT_MSG_EQ (result.GetCumulativeLost (), -5, "Wrong cumulative lost");
+  NS_TEST_EXPECT_MSG_EQ (result.GetHighestSeq (), 70000, "Wrong highest sequence");
+  NS_TEST_EXPECT_MSG_EQ (result.GetJitter (), MicroSeconds (1234), "Wrong jitter");
+  NS_TEST_EXPECT_MSG_EQ (result.GetLastSr (), Seconds (1.5), "Wrong LSR");
+  NS_TEST_EXPECT_MSG_EQ (result.GetDelaySinceLastSr (), MilliSeconds (250), "Wrong DLSR");
+  NS_TEST_EXPECT_MSG_EQ (result.GetOneWayDelay (), MicroSeconds (20000), "Wrong one-way delay");
+  NS_TEST_EXPECT_MSG_EQ (result.GetRoundTripTime (Seconds (2)), MilliSeconds (250), "Wrong RTT");
+}
+
+class RtcpNackHeaderTestCase : public TestCase
+{
+public:
+  RtcpNackHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtcpNackHeaderTestCase::RtcpNackHeaderTestCase ()
+  : TestCase ("RtcpNackHeader serialize/deserialize round trip")
+{
+}
+
+void
+RtcpNackHeaderTestCase::DoRun (void)
+{
+  //100 뒤 16개 이내(101, 116)는 BLP로 묶이고 117, 300은 새 항목
+  std::vector<uint16_t> lost;
+  lost.push_back (100);
+  lost.push_back (101);
+  lost.push_back (116);
+  lost.push_back (117);
+  lost.push_back (300);
+
+  RtcpNackHeader header;
+  header.SetSenderSsrc (33);
+  header.SetMediaSsrc (44);
+  for (uint32_t idx = 0; idx < lost.size (); idx++)
+    {
+      header.AddLostSequence (lost[idx]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (header.GetItemCount (), 3, "Wrong PID/BLP item count");
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), header.GetSerializedSize (), "Wrong serialized size");
+
+  RtcpCommonHeader common;
+  packet->PeekHeader (common);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) common.GetPacketType (), (uint32_t) RtcpNackHeader::PT_RTPFB,
+                         "Wrong packet type");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) common.GetCount (), (uint32_t) RtcpNackHeader::FMT_GENERIC_NACK,
+                         "Wrong feedback message type");
+
+  RtcpNackHeader result;
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (result.GetSenderSsrc (), 33, "Wrong sender SSRC");
+  NS_TEST_EXPECT_MSG_EQ (result.GetMediaSsrc (), 44, "Wrong media SSRC");
+  NS_TEST_EXPECT_MSG_EQ (result.GetItemCount (), 3, "Wrong PID/BLP item count");
+  NS_TEST_EXPECT_MSG_EQ ((result.GetLostSequences () == lost), true, "Wrong lost sequences");
+}
+
+class RtspHeaderTestCase : public TestCase
+{
+public:
+  RtspHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtspHeaderTestCase::RtspHeaderTestCase ()
+  : TestCase ("RtspHeader serialize/deserialize round trip")
+{
+}
+
+void
+RtspHeaderTestCase::DoRun (void)
+{
+  RtspHeader header;
+  header.SetMethod (RtspHeader::SETUP);
+  header.SetStatus (RtspHeader::OK);
+  header.SetCSeq (9);
+  header.SetSession (77);
+  header.SetClientPorts (5000, 5001);
+  header.SetMulticast (true);
+  header.SetNack (true);
+  header.SetDestination (Ipv4Address ("225.1.2.3"));
+  header.SetFramePeriod (40);
+  header.SetFrameCount (1500);
+  header.SetUrl ("scratch/frame.txt,scratch/frame2.txt");
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), header.GetSerializedSize (), "Wrong serialized size");
+  NS_TEST_EXPECT_MSG_EQ (RtspHeader::PeekMessageSize (packet), header.GetSerializedSize (),
+                         "Wrong message length prefix");
+
+  RtspHeader result;
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (result.GetMethod (), RtspHeader::SETUP, "Wrong method");
+  NS_TEST_EXPECT_MSG_EQ (result.GetStatus (), RtspHeader::OK, "Wrong status");
+  NS_TEST_EXPECT_MSG_EQ (result.IsResponse (), true, "Response not detected");
+  NS_TEST_EXPECT_MSG_EQ (result.GetCSeq (), 9, "Wrong CSeq");
+  NS_TEST_EXPECT_MSG_EQ (result.GetSession (), 77, "Wrong session");
+  NS_TEST_EXPECT_MSG_EQ (result.GetClientRtpPort (), 5000, "Wrong RTP port");
+  NS_TEST_EXPECT_MSG_EQ (result.GetClientRtcpPort (), 5001, "Wrong RTCP port");
+  NS_TEST_EXPECT_MSG_EQ (result.IsMulticast (), true, "Wrong multicast flag");
+  NS_TEST_EXPECT_MSG_EQ (result.IsNack (), true, "Wrong NACK flag");
+  NS_TEST_EXPECT_MSG_EQ (result.GetDestination (), Ipv4Address ("225.1.2.3"), "Wrong destination");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFramePeriod (), 40, "Wrong frame period");
+  NS_TEST_EXPECT_MSG_EQ (result.GetFrameCount (), 1500, "Wrong frame count");
+  NS_TEST_EXPECT_MSG_EQ (result.GetUrl (), "scratch/frame.txt,scratch/frame2.txt", "Wrong url");
+
+  //url이 없는 요청은 고정 크기만 차지하고, 이전 메시지의 url이 남지 않아야 함
+  RtspHeader play;
+  play.SetMethod (RtspHeader::PLAY);
+  play.SetCSeq (10);
+  packet = Create<Packet> ();
+  packet->AddHeader (play);
+  packet->RemoveHeader (result);
+  NS_TEST_EXPECT_MSG_EQ (result.GetMethod (), RtspHeader::PLAY, "Wrong method");
+  NS_TEST_EXPECT_MSG_EQ (result.IsResponse (), false, "Request detected as response");
+  NS_TEST_EXPECT_MSG_EQ (result.GetUrl (), "", "Stale url");
+  NS_TEST_EXPECT_MSG_EQ (result.IsNack (), false, "Stale NACK flag");
+}
+
+class RtspHeaderTestSuite : public TestSuite
+{
+public:
+  RtspHeaderTestSuite ();
+};
+
+RtspHeaderTestSuite::RtspHeaderTestSuite ()
+  : TestSuite ("rtsp-header", UNIT)
+{
+  AddTestCase (new RtpHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new RtpFecHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new RtcpReceiverReportHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new RtcpNackHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new RtspHeaderTestCase, TestCase::QUICK);
+}
+
+static RtspHeaderTestSuite g_rtspHeaderTestSuite;
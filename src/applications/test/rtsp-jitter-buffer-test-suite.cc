@@ -0,0 +1,164 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTP 지터 버퍼 테스트
+
+링 버퍼의 조각 추가, 슬롯 재사용(wrap), 재생 위치 이전 프레임 버림,
+범위를 넘는 프레임에 의한 밀어내기를 확인합니다.
+
+*/
+
+#include <ns3/test.h>
+#include <ns3/rtp-jitter-buffer.h>
+
+using namespace ns3;
+
+class RtpJitterBufferInsertTestCase : public TestCase
+{
+public:
+  RtpJitterBufferInsertTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtpJitterBufferInsertTestCase::RtpJitterBufferInsertTestCase ()
+  : TestCase ("RtpJitterBuffer collects fragments of a frame")
+{
+}
+
+void
+RtpJitterBufferInsertTestCase::DoRun (void)
+{
+  RtpJitterBuffer buffer (8);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetCapacity (), 8, "Wrong capacity");
+
+  RtpJitterBuffer::Entry *entry = buffer.Insert (2, 3, 1000, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_NE (entry, 0, "Insert failed");
+  NS_TEST_EXPECT_MSG_EQ (entry->IsComplete (), false, "Frame complete after one of three fragments");
+  buffer.Insert (2, 3, 1000, MilliSeconds (11));
+  entry = buffer.Insert (2, 3, 500, MilliSeconds (12));
+  NS_TEST_EXPECT_MSG_EQ (entry->IsComplete (), true, "Frame incomplete after all fragments");
+  NS_TEST_EXPECT_MSG_EQ (entry->size, 2500, "Wrong frame size");
+  NS_TEST_EXPECT_MSG_EQ (entry->arrival, MilliSeconds (10), "Arrival is not the first fragment");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 1, "Fragments counted as frames");
+
+  buffer.Insert (5, 1, 100, MilliSeconds (20));
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (2), entry, "Find returned another slot");
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (3), 0, "Found a frame that never arrived");
+  NS_TEST_ASSERT_MSG_NE (buffer.FindNext (3), 0, "FindNext missed frame 5");
+  NS_TEST_EXPECT_MSG_EQ (buffer.FindNext (3)->frameId, 5, "FindNext returned the wrong frame");
+  NS_TEST_EXPECT_MSG_EQ (buffer.FindNext (6), 0, "FindNext past the newest frame");
+}
+
+class RtpJitterBufferWrapTestCase : public TestCase
+{
+public:
+  RtpJitterBufferWrapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtpJitterBufferWrapTestCase::RtpJitterBufferWrapTestCase ()
+  : TestCase ("RtpJitterBuffer reuses slots after DiscardBefore")
+{
+}
+
+void
+RtpJitterBufferWrapTestCase::DoRun (void)
+{
+  RtpJitterBuffer buffer (4);
+  for (uint32_t frameId = 0; frameId < 4; frameId++)
+    {
+      buffer.Insert (frameId, 1, 100, Seconds (0));
+    }
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 4, "Buffer not full");
+
+  //재생한 프레임을 버리면 같은 슬롯(frameId % 4)에 다음 프레임이 들어감
+  buffer.DiscardBefore (2);
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetHead (), 2, "Wrong head");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 2, "Discarded frames still counted");
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (1), 0, "Discarded frame still found");
+
+  buffer.Insert (4, 1, 100, Seconds (1));
+  buffer.Insert (5, 1, 100, Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 4, "Wrapped frames not stored");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetEvicted (), 0, "Frames evicted inside the window");
+  NS_TEST_ASSERT_MSG_NE (buffer.Find (4), 0, "Wrapped frame 4 missing");
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (4)->frameId, 4, "Slot holds a stale frame");
+  NS_TEST_ASSERT_MSG_NE (buffer.Find (2), 0, "Frame 2 overwritten");
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (2)->frameId, 2, "Frame 2 overwritten");
+
+  //이미 버린 구간의 늦은 조각은 받지 않음
+  NS_TEST_EXPECT_MSG_EQ (buffer.Insert (1, 1, 100, Seconds (2)), 0, "Late frame accepted");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 4, "Late frame counted");
+
+  //window보다 멀리 건너뛰어도 슬롯이 모두 비워져야 함
+  buffer.DiscardBefore (100);
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 0, "Frames left after a long discard");
+  NS_TEST_EXPECT_MSG_EQ (buffer.FindNext (0), 0, "Frame found after a long discard");
+}
+
+class RtpJitterBufferEvictTestCase : public TestCase
+{
+public:
+  RtpJitterBufferEvictTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtpJitterBufferEvictTestCase::RtpJitterBufferEvictTestCase ()
+  : TestCase ("RtpJitterBuffer evicts the oldest frames on overflow")
+{
+}
+
+void
+RtpJitterBufferEvictTestCase::DoRun (void)
+{
+  RtpJitterBuffer buffer (4);
+  for (uint32_t frameId = 10; frameId < 14; frameId++)
+    {
+      buffer.Insert (frameId, 1, 100, Seconds (0));
+    }
+  buffer.DiscardBefore (10);
+
+  //범위 [10, 14)를 넘는 프레임 15는 10, 11을 밀어냄
+  RtpJitterBuffer::Entry *entry = buffer.Insert (15, 2, 100, Seconds (1));
+  NS_TEST_ASSERT_MSG_NE (entry, 0, "Insert beyond the window failed");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetHead (), 12, "Wrong head after eviction");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetEvicted (), 2, "Wrong evicted count");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 3, "Wrong frame count after eviction");
+  NS_TEST_EXPECT_MSG_EQ (buffer.Find (11), 0, "Evicted frame still found");
+  NS_TEST_EXPECT_MSG_EQ (entry->frameId, 15, "Wrong frame in slot");
+  NS_TEST_EXPECT_MSG_EQ (entry->fragments, 1, "Slot kept fragments of the evicted frame");
+
+  //빈 구간만 밀어낸 경우는 세지 않음
+  buffer.DiscardBefore (16);
+  buffer.Insert (30, 1, 100, Seconds (2));
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetEvicted (), 2, "Empty slots counted as evicted");
+
+  //용량을 바꾸면 버퍼와 통계가 비워짐
+  buffer.SetCapacity (16);
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 0, "SetCapacity kept frames");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetEvicted (), 0, "SetCapacity kept the evicted count");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetFootprint (), 16 * sizeof (RtpJitterBuffer::Entry), "Wrong footprint");
+}
+
+class RtspJitterBufferTestSuite : public TestSuite
+{
+public:
+  RtspJitterBufferTestSuite ();
+};
+
+RtspJitterBufferTestSuite::RtspJitterBufferTestSuite ()
+  : TestSuite ("rtsp-jitter-buffer", UNIT)
+{
+  AddTestCase (new RtpJitterBufferInsertTestCase, TestCase::QUICK);
+  AddTestCase (new RtpJitterBufferWrapTestCase, TestCase::QUICK);
+  AddTestCase (new RtpJitterBufferEvictTestCase, TestCase::QUICK);
+}
+
+static RtspJitterBufferTestSuite g_rtspJitterBufferTestSuite;
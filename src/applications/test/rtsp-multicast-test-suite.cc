@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP multicast 전달 테스트
+
+RtspScenarioHelper의 tree 토폴로지에서 multicast를 요청한 클라이언트 여러 개가
+서버의 multicast 스트림 하나를 라우터의 정적 multicast 경로를 거쳐 모두 받는지 확인합니다.
+
+*/
+
+#include <fstream>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/string.h>
+#include <ns3/ipv4-address.h>
+#include <ns3/rtsp-scenario-helper.h>
+
+using namespace ns3;
+
+class RtspMulticastDeliveryTestCase : public TestCase
+{
+public:
+  RtspMulticastDeliveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void RecordStreamCount (void);
+
+  Ptr<RtspServer> m_server;
+  uint32_t m_streamCount;
+};
+
+RtspMulticastDeliveryTestCase::RtspMulticastDeliveryTestCase ()
+  : TestCase ("Clients on different branches share one routed multicast stream"),
+    m_streamCount (0)
+{
+}
+
+void
+RtspMulticastDeliveryTestCase::RecordStreamCount (void)
+{
+  m_streamCount = m_server->GetMulticastStreamCount ();
+}
+
+void
+RtspMulticastDeliveryTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("rtsp-multicast-trace.txt");
+  std::ofstream trace (fileName.c_str ());
+  for (uint32_t frame = 0; frame < 200; frame++)
+    {
+      trace << 8000 << std::endl;
+    }
+  trace.close ();
+
+  //브랜치 0에 클라이언트 0, 2, 브랜치 1에 클라이언트 1
+  const uint32_t clients = 3;
+  RtspScenarioHelper scenario;
+  scenario.SetTopology (RtspScenarioHelper::TREE);
+  scenario.SetTreeBranches (2);
+  scenario.SetClientCount (clients);
+  scenario.SetSchedule (MilliSeconds (100), MilliSeconds (10), MilliSeconds (100));
+  scenario.SetStopTime (Seconds (3));
+  scenario.SetServerAttribute ("MulticastGroup", Ipv4AddressValue (Ipv4Address ("225.1.2.1")));
+  scenario.SetClientAttribute ("FileName", StringValue (fileName));
+  scenario.SetClientAttribute ("Multicast", BooleanValue (true));
+  scenario.Build ();
+
+  m_server = scenario.GetServer (0);
+  Simulator::Schedule (Seconds (2), &RtspMulticastDeliveryTestCase::RecordStreamCount, this);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_streamCount, 1, "Clients not sharing a single multicast stream");
+  for (uint32_t i = 0; i < clients; i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (scenario.GetClient (i)->GetRxSize (), 0,
+                             "Client " << i << " received no multicast RTP");
+    }
+
+  m_server = 0;
+  Simulator::Destroy ();
+}
+
+class RtspMulticastTestSuite : public TestSuite
+{
+public:
+  RtspMulticastTestSuite ();
+};
+
+RtspMulticastTestSuite::RtspMulticastTestSuite ()
+  : TestSuite ("rtsp-multicast", SYSTEM)
+{
+  AddTestCase (new RtspMulticastDeliveryTestCase, TestCase::QUICK);
+}
+
+static RtspMulticastTestSuite g_rtspMulticastTestSuite;
@@ -0,0 +1,112 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTCP NACK 재전송 테스트
+
+point-to-point 링크로 연결된 RtspServer와 RtspClient 사이에서
+클라이언트로 가는 첫 RTP 미디어 패킷 중 하나를 버리고, FEC 없이 NACK 재전송으로 복구되는지 확인합니다.
+클라이언트가 SETUP에서 NACK 사용을 알리므로 서버는 첫 패킷부터 send history에 보관해야 합니다.
+
+*/
+
+#include <fstream>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <ns3/pointer.h>
+#include <ns3/string.h>
+#include <ns3/internet-stack-helper.h>
+#include <ns3/ipv4-address-helper.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/rtsp-client-server-helper.h>
+#include "rtp-seq-error-model.h"
+
+using namespace ns3;
+
+class RtspNackRecoveryTestCase : public TestCase
+{
+public:
+  RtspNackRecoveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtspNackRecoveryTestCase::RtspNackRecoveryTestCase ()
+  : TestCase ("NACK retransmission recovers an early lost RTP packet")
+{
+}
+
+void
+RtspNackRecoveryTestCase::DoRun (void)
+{
+  //프레임마다 RTP 패킷 여러 개로 나뉘도록 큰 프레임의 트레이스 생성
+  std::string fileName = CreateTempDirFilename ("rtsp-nack-trace.txt");
+  std::ofstream trace (fileName.c_str ());
+  for (uint32_t frame = 0; frame < 200; frame++)
+    {
+      trace << 64000 << std::endl;
+    }
+  trace.close ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  const uint16_t rtpPort = 5004;
+  //첫 NACK을 보내기 전에 보낸 패킷이어도 재전송되어야 함
+  Ptr<RtpSeqErrorModel> errorModel = CreateObject<RtpSeqErrorModel> ();
+  errorModel->SetTarget (rtpPort, 1);
+  devices.Get (0)->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+
+  RtspServerHelper server (Address (interfaces.GetAddress (1)));
+  ApplicationContainer apps = server.Install (nodes.Get (1));
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (3));
+
+  RtspClientHelper client (Address (interfaces.GetAddress (1)), Address (interfaces.GetAddress (0)));
+  client.SetAttribute ("FileName", StringValue (fileName));
+  client.SetAttribute ("RtpPort", UintegerValue (rtpPort));
+  client.SetAttribute ("EnableNack", BooleanValue (true));
+  apps = client.Install (nodes.Get (0));
+  client.ScheduleMessage (MilliSeconds (100), RtspClient::SETUP);
+  client.ScheduleMessage (MilliSeconds (200), RtspClient::PLAY);
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (3));
+
+  Ptr<RtspClient> rtspClient = DynamicCast<RtspClient> (apps.Get (0));
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (errorModel->GetDropped (), 1, "RTP packet was not dropped");
+  NS_TEST_EXPECT_MSG_EQ (rtspClient->GetRecoveredPackets (), 1, "Lost RTP packet not retransmitted");
+  NS_TEST_EXPECT_MSG_EQ (rtspClient->GetFecRecoveredPackets (), 0, "Packet recovered without FEC enabled");
+
+  Simulator::Destroy ();
+}
+
+class RtspNackTestSuite : public TestSuite
+{
+public:
+  RtspNackTestSuite ();
+};
+
+RtspNackTestSuite::RtspNackTestSuite ()
+  : TestSuite ("rtsp-nack", SYSTEM)
+{
+  AddTestCase (new RtspNackRecoveryTestCase, TestCase::QUICK);
+}
+
+static RtspNackTestSuite g_rtspNackTestSuite;
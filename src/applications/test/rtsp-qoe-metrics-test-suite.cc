@@ -0,0 +1,91 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP QoE 지표 테스트
+
+재생/부재 알림 순서에 따른 startup delay, stall 횟수와 길이,
+rebuffer ratio, 평균 비트레이트, quality switch 누적을 확인합니다.
+
+*/
+
+#include <ns3/test.h>
+#include <ns3/rtsp-qoe-metrics.h>
+
+using namespace ns3;
+
+class RtspQoeStallTestCase : public TestCase
+{
+public:
+  RtspQoeStallTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RtspQoeStallTestCase::RtspQoeStallTestCase ()
+  : TestCase ("RtspQoeMetrics stall accounting")
+{
+}
+
+void
+RtspQoeStallTestCase::DoRun (void)
+{
+  const Time period = MilliSeconds (40);
+  RtspQoeMetrics qoe;
+  qoe.NotifyPlayRequest (MilliSeconds (1000));
+
+  //첫 프레임 이전의 부재는 stall이 아니라 startup delay
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyFrameMissing (MilliSeconds (1100)), false, "Stall before the first frame");
+  NS_TEST_EXPECT_MSG_EQ (qoe.HasStarted (), false, "Started without a frame");
+  Time stall = qoe.NotifyFramePlayed (MilliSeconds (1200), period, 1000, 0);
+  NS_TEST_EXPECT_MSG_EQ (stall, Time (0), "Stall ended by the first frame");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStartupDelay (), MilliSeconds (200), "Wrong startup delay");
+  qoe.NotifyFramePlayed (MilliSeconds (1240), period, 1000, 0);
+
+  //연속된 부재는 stall 하나
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyFrameMissing (MilliSeconds (1280)), true, "Stall not started");
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyFrameMissing (MilliSeconds (1320)), false, "Stall started twice");
+  NS_TEST_EXPECT_MSG_EQ (qoe.IsStalled (), true, "Not stalled");
+  stall = qoe.NotifyFramePlayed (MilliSeconds (1400), period, 500, 1);
+  NS_TEST_EXPECT_MSG_EQ (stall, MilliSeconds (120), "Wrong stall length");
+  NS_TEST_EXPECT_MSG_EQ (qoe.IsStalled (), false, "Still stalled after a frame");
+
+  //PAUSE/종료가 진행 중인 stall을 끝냄
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyFrameMissing (MilliSeconds (1440)), true, "Second stall not started");
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyStop (MilliSeconds (1500)), MilliSeconds (60), "Wrong stall length at stop");
+  NS_TEST_EXPECT_MSG_EQ (qoe.NotifyStop (MilliSeconds (1600)), Time (0), "Stop without a stall returned a stall");
+
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStallCount (), 2, "Wrong stall count");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStallDuration (), MilliSeconds (180), "Wrong stall duration");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetPlayDuration (), MilliSeconds (120), "Wrong play duration");
+  NS_TEST_EXPECT_MSG_EQ_TOL (qoe.GetRebufferRatio (), 0.6, 1e-9, "Wrong rebuffer ratio");
+  NS_TEST_EXPECT_MSG_EQ_TOL (qoe.GetAverageBitrate (), 2500 * 8 / 0.12, 1e-6, "Wrong average bitrate");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetQualitySwitches (), 1, "Wrong quality switch count");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetRepresentation (), 1, "Wrong representation");
+
+  //PAUSE 후 다시 PLAY해도 startup delay는 바뀌지 않음
+  qoe.NotifyPlayRequest (MilliSeconds (2000));
+  qoe.NotifyFramePlayed (MilliSeconds (2100), period, 0, 1);
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStartupDelay (), MilliSeconds (200), "Startup delay measured again");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStallCount (), 2, "Resume counted as a stall");
+
+  qoe.Reset ();
+  NS_TEST_EXPECT_MSG_EQ (qoe.HasStarted (), false, "Reset kept the start");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetStallCount (), 0, "Reset kept stalls");
+  NS_TEST_EXPECT_MSG_EQ (qoe.GetRebufferRatio (), 0, "Rebuffer ratio without playback");
+}
+
+class RtspQoeMetricsTestSuite : public TestSuite
+{
+public:
+  RtspQoeMetricsTestSuite ();
+};
+
+RtspQoeMetricsTestSuite::RtspQoeMetricsTestSuite ()
+  : TestSuite ("rtsp-qoe-metrics", UNIT)
+{
+  AddTestCase (new RtspQoeStallTestCase, TestCase::QUICK);
+}
+
+static RtspQoeMetricsTestSuite g_rtspQoeMetricsTestSuite;
@@ -0,0 +1,216 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 전송률 제어 테스트
+
+RtspLevelRateController가 분리 전 RtspServer/RtspClient의 congestion level 제어와
+같은 2배 증가/절반 감소 순서를 만드는지 확인합니다.
+기존 방식은 클라이언트가 loss 비율을 평활화해서 보내고 서버가 그 값으로 level을 바꿨으므로,
+아래 BaselineLevel은 두 부분을 그대로 옮겨 놓은 기준 모델입니다.
+
+*/
+
+#include <ns3/test.h>
+#include <ns3/boolean.h>
+#include <ns3/rtsp-rate-controller.h>
+
+using namespace ns3;
+
+//분리 전 코드의 congestion level 제어
+class BaselineLevel
+{
+public:
+  BaselineLevel (bool useCongestionThreshold)
+    : m_congestionLevel (16),
+      m_congestionThreshold (16 + 1),
+      m_useCongestionThreshold (useCongestionThreshold),
+      m_upscale (0),
+      m_lastFractionLost (0)
+  {
+  }
+
+  //클라이언트: 보고 구간의 loss 비율을 평활화해서 전송
+  //서버: 받은 값으로 level 조절
+  void Report (float rawFractionLost)
+  {
+    float fractionLost = (rawFractionLost * 0.85) + (m_lastFractionLost * 0.15);
+    m_lastFractionLost = fractionLost;
+
+    if(fractionLost >= 0 && fractionLost <= 0.05)
+    {
+      if(
+        m_upscale == int(MAX_CONGESTION_LEVEL + 2 - m_congestionLevel)
+        && m_congestionLevel > MIN_CONGESTION_LEVEL
+        && (
+            !m_useCongestionThreshold ||
+            (m_congestionThreshold > MAX_CONGESTION_LEVEL || m_congestionLevel > m_congestionThreshold)
+        )
+      )
+      {
+        m_congestionLevel /= 2;
+        m_upscale = 0;
+      }
+      else m_upscale++;
+    }
+    else if(fractionLost > 0.2)
+    {
+      if(m_congestionLevel < MAX_CONGESTION_LEVEL) {
+        m_congestionLevel *= 2;
+      }
+      if(m_congestionThreshold > m_congestionLevel) {
+        m_congestionThreshold = m_congestionLevel;
+      }
+      m_upscale = 0;
+    }
+  }
+
+  //MODIFY 요청
+  void Modify (void)
+  {
+    if(m_congestionLevel > MIN_CONGESTION_LEVEL)
+    {
+      m_congestionLevel /= 2;
+      m_congestionThreshold = MAX_CONGESTION_LEVEL + 1;
+    }
+  }
+
+  double GetLevel (void) const
+  {
+    return m_congestionLevel;
+  }
+
+private:
+  const double MAX_CONGESTION_LEVEL = 16;
+  const double MIN_CONGESTION_LEVEL = 1;
+  double m_congestionLevel;
+  double m_congestionThreshold;
+  bool m_useCongestionThreshold;
+  int32_t m_upscale;
+  float m_lastFractionLost;
+};
+
+class RtspLevelRateControllerTestCase : public TestCase
+{
+public:
+  RtspLevelRateControllerTestCase (bool useCongestionThreshold);
+
+private:
+  virtual void DoRun (void);
+  //보고 하나를 양쪽에 넣고 level이 같은지 확인
+  void Report (double fractionLost, uint32_t index);
+  double GetLevel (void) const;
+
+  bool m_useCongestionThreshold;
+  Ptr<RtspLevelRateController> m_controller;
+  BaselineLevel m_baseline;
+};
+
+RtspLevelRateControllerTestCase::RtspLevelRateControllerTestCase (bool useCongestionThreshold)
+  : TestCase (useCongestionThreshold
+              ? "RtspLevelRateController reproduces the baseline levels with the congestion threshold"
+              : "RtspLevelRateController reproduces the baseline levels without the congestion threshold"),
+    m_useCongestionThreshold (useCongestionThreshold),
+    m_baseline (useCongestionThreshold)
+{
+}
+
+double
+RtspLevelRateControllerTestCase::GetLevel (void) const
+{
+  return m_controller->GetMaxRate () / m_controller->GetTargetRate ();
+}
+
+void
+RtspLevelRateControllerTestCase::Report (double fractionLost, uint32_t index)
+{
+  RtspRateFeedback feedback;
+  feedback.fractionLost = fractionLost;
+  feedback.rtt = Time (0);
+  feedback.jitter = Time (0);
+  feedback.oneWayDelay = Time (0);
+  feedback.now = MilliSeconds (100 * index);
+  m_controller->OnReport (feedback);
+  m_baseline.Report (fractionLost);
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), m_baseline.GetLevel (), 1e-9,
+                             "Level differs from the baseline at report " << index);
+}
+
+void
+RtspLevelRateControllerTestCase::DoRun (void)
+{
+  m_controller = CreateObject<RtspLevelRateController> ();
+  m_controller->SetAttribute ("UseCongestionThreshold", BooleanValue (m_useCongestionThreshold));
+  m_controller->Reset (1.6e6);
+  NS_TEST_ASSERT_MSG_EQ_TOL (GetLevel (), 16, 1e-9, "Not started at the maximum level");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_controller->GetTargetRate (), 1e5, 1e-3, "Wrong minimum rate");
+
+  //loss가 없으면 level L에서 (18 - L)번 보고 후 절반: 16 -> 8 -> 4 -> 2 -> 1
+  uint32_t index = 0;
+  uint32_t levelChanges[] = { 3, 14, 29, 46 };
+  double levels[] = { 8, 4, 2, 1 };
+  for (uint32_t step = 0; step < 4; step++)
+    {
+      while (index < levelChanges[step])
+        {
+          Report (0, ++index);
+        }
+      NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), levels[step], 1e-9, "Wrong level after " << index << " reports");
+    }
+
+  //loss가 크면 보고마다 2배, 그 level이 threshold가 됨
+  Report (0.5, ++index);
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), 2, 1e-9, "Level not doubled on loss");
+  Report (0.5, ++index);
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), 4, 1e-9, "Level not doubled on loss");
+
+  //loss가 없어지면 다시 절반씩 줄어듦 (평활화된 loss가 0.05 이하가 될 때부터)
+  for (uint32_t idx = 0; idx < 60; idx++)
+    {
+      Report (0, ++index);
+    }
+  //threshold를 쓰면 처음 loss가 난 level 2 아래로 내려가지 않음
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), m_useCongestionThreshold ? 2 : 1, 1e-9, "Wrong level after recovery");
+
+  //평활화된 loss가 0.05~0.2 사이인 보고가 섞인 순서
+  double pattern[] = { 0.1, 0.3, 0, 0.04, 0.25, 0.02, 0, 0.15, 0, 0 };
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      for (uint32_t idx = 0; idx < sizeof (pattern) / sizeof (pattern[0]); idx++)
+        {
+          Report (pattern[idx], ++index);
+        }
+      for (uint32_t idx = 0; idx < round * 3; idx++)
+        {
+          Report (0, ++index);
+        }
+    }
+
+  //MODIFY는 한 단계 올리고 threshold를 지움
+  m_controller->OnModify ();
+  m_baseline.Modify ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), m_baseline.GetLevel (), 1e-9, "Level differs from the baseline after MODIFY");
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetLevel (), 1, 1e-9, "MODIFY did not raise the quality");
+  for (uint32_t idx = 0; idx < 20; idx++)
+    {
+      Report (0, ++index);
+    }
+
+  m_controller->Dispose ();
+  m_controller = 0;
+}
+
+class RtspRateControllerTestSuite : public TestSuite
+{
+public:
+  RtspRateControllerTestSuite ();
+};
+
+RtspRateControllerTestSuite::RtspRateControllerTestSuite ()
+  : TestSuite ("rtsp-rate-controller", UNIT)
+{
+  AddTestCase (new RtspLevelRateControllerTestCase (true), TestCase::QUICK);
+  AddTestCase (new RtspLevelRateControllerTestCase (false), TestCase::QUICK);
+}
+
+static RtspRateControllerTestSuite g_rtspRateControllerTestSuite;
@@ -0,0 +1,208 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+
+RTSP 공유 tick 드라이버 테스트
+
+tick 도중의 Add/Remove가 현재 tick의 호출 순서를 깨지 않는지,
+delay와 주기 별 그룹, 그룹이 빈 뒤 이벤트가 남지 않는지를 확인합니다.
+
+*/
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/rtsp-tick-driver.h>
+
+using namespace ns3;
+
+class RtspTickDriverRemoveTestCase : public TestCase
+{
+public:
+  RtspTickDriverRemoveTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TickA (void);
+  void TickB (void);
+  void TickC (void);
+  void TickD (void);
+  void RemoveAll (void);
+
+  Ptr<RtspTickDriver> m_driver;
+  uint32_t m_idA, m_idB, m_idC, m_idD;
+  uint32_t m_countA, m_countB, m_countC, m_countD;
+  uint32_t m_membersAfterFirstTick;
+};
+
+RtspTickDriverRemoveTestCase::RtspTickDriverRemoveTestCase ()
+  : TestCase ("RtspTickDriver add and remove during a tick"),
+    m_idA (RtspTickDriver::INVALID),
+    m_idB (RtspTickDriver::INVALID),
+    m_idC (RtspTickDriver::INVALID),
+    m_idD (RtspTickDriver::INVALID),
+    m_countA (0),
+    m_countB (0),
+    m_countC (0),
+    m_countD (0),
+    m_membersAfterFirstTick (0)
+{
+}
+
+void
+RtspTickDriverRemoveTestCase::TickA (void)
+{
+  m_countA++;
+  if (m_countA == 2)
+    {
+      //첫 tick이 끝난 뒤 남은 멤버 수 (A, B, D)
+      m_membersAfterFirstTick = m_driver->GetMemberCount ();
+    }
+}
+
+//첫 tick에서 아직 호출되지 않은 C를 지우고 D를 추가, 두 번째 tick에서 자신을 지움
+void
+RtspTickDriverRemoveTestCase::TickB (void)
+{
+  m_countB++;
+  if (m_countB == 1)
+    {
+      m_driver->Remove (m_idC);
+      m_idD = m_driver->Add (MilliSeconds (10), MakeCallback (&RtspTickDriverRemoveTestCase::TickD, this));
+    }
+  else if (m_countB == 2)
+    {
+      m_driver->Remove (m_idB);
+    }
+}
+
+void
+RtspTickDriverRemoveTestCase::TickC (void)
+{
+  m_countC++;
+}
+
+void
+RtspTickDriverRemoveTestCase::TickD (void)
+{
+  m_countD++;
+}
+
+void
+RtspTickDriverRemoveTestCase::RemoveAll (void)
+{
+  m_driver->Remove (m_idA);
+  m_driver->Remove (m_idD);
+  //이미 지운 ID는 무시
+  m_driver->Remove (m_idB);
+}
+
+void
+RtspTickDriverRemoveTestCase::DoRun (void)
+{
+  m_driver = CreateObject<RtspTickDriver> ();
+  m_idA = m_driver->Add (MilliSeconds (10), MakeCallback (&RtspTickDriverRemoveTestCase::TickA, this));
+  m_idB = m_driver->Add (MilliSeconds (10), MakeCallback (&RtspTickDriverRemoveTestCase::TickB, this));
+  m_idC = m_driver->Add (MilliSeconds (10), MakeCallback (&RtspTickDriverRemoveTestCase::TickC, this));
+  NS_TEST_ASSERT_MSG_EQ (m_driver->GetMemberCount (), 3, "Wrong member count");
+  NS_TEST_ASSERT_MSG_EQ (m_driver->GetGroupCount (), 1, "Same period split into groups");
+
+  //tick 시각: 10, 20, 30ms, 35ms에 모두 지우면 더 이상 이벤트가 없어야 함
+  Simulator::Schedule (MilliSeconds (35), &RtspTickDriverRemoveTestCase::RemoveAll, this);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_countA, 3, "A missed ticks");
+  NS_TEST_EXPECT_MSG_EQ (m_countB, 2, "B called after removing itself");
+  NS_TEST_EXPECT_MSG_EQ (m_countC, 0, "C called after removal earlier in the same tick");
+  NS_TEST_EXPECT_MSG_EQ (m_countD, 2, "D added during a tick was not called from the next tick on");
+  NS_TEST_EXPECT_MSG_EQ (m_membersAfterFirstTick, 3, "Wrong member count after the first tick");
+  NS_TEST_EXPECT_MSG_EQ (m_driver->GetMemberCount (), 0, "Members left after RemoveAll");
+  NS_TEST_EXPECT_MSG_EQ (m_driver->GetTickCount (), 3, "Tick events after the group became empty");
+
+  m_driver->Dispose ();
+  m_driver = 0;
+  Simulator::Destroy ();
+}
+
+class RtspTickDriverDelayTestCase : public TestCase
+{
+public:
+  RtspTickDriverDelayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Record (void);
+  void RemoveMembers (void);
+
+  Ptr<RtspTickDriver> m_driver;
+  std::vector<uint32_t> m_ids;
+  std::vector<Time> m_calls;
+};
+
+RtspTickDriverDelayTestCase::RtspTickDriverDelayTestCase ()
+  : TestCase ("RtspTickDriver aligns delayed members and groups periods")
+{
+}
+
+void
+RtspTickDriverDelayTestCase::Record (void)
+{
+  m_calls.push_back (Simulator::Now ());
+}
+
+void
+RtspTickDriverDelayTestCase::RemoveMembers (void)
+{
+  for (uint32_t idx = 0; idx < m_ids.size (); idx++)
+    {
+      m_driver->Remove (m_ids[idx]);
+    }
+}
+
+void
+RtspTickDriverDelayTestCase::DoRun (void)
+{
+  m_driver = CreateObject<RtspTickDriver> ();
+
+  //delay 15ms는 주기 10ms의 정수배 tick 중 첫 tick인 20ms부터 호출
+  m_ids.push_back (m_driver->Add (MilliSeconds (10), MakeCallback (&RtspTickDriverDelayTestCase::Record, this),
+                                  MilliSeconds (15)));
+  //다른 주기는 별도 그룹
+  m_ids.push_back (m_driver->Add (MilliSeconds (25), MakeCallback (&RtspTickDriverDelayTestCase::Record, this)));
+  NS_TEST_ASSERT_MSG_EQ (m_driver->GetGroupCount (), 2, "Different periods share a group");
+
+  Simulator::Schedule (MilliSeconds (45), &RtspTickDriverDelayTestCase::RemoveMembers, this);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  //10ms 그룹: 20, 30, 40ms, 25ms 그룹: 25ms
+  std::vector<Time> expected;
+  expected.push_back (MilliSeconds (20));
+  expected.push_back (MilliSeconds (25));
+  expected.push_back (MilliSeconds (30));
+  expected.push_back (MilliSeconds (40));
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), expected.size (), "Wrong number of calls");
+  for (uint32_t idx = 0; idx < expected.size (); idx++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_calls[idx], expected[idx], "Wrong call time " << idx);
+    }
+
+  m_driver->Dispose ();
+  m_driver = 0;
+  Simulator::Destroy ();
+}
+
+class RtspTickDriverTestSuite : public TestSuite
+{
+public:
+  RtspTickDriverTestSuite ();
+};
+
+RtspTickDriverTestSuite::RtspTickDriverTestSuite ()
+  : TestSuite ("rtsp-tick-driver", UNIT)
+{
+  AddTestCase (new RtspTickDriverRemoveTestCase, TestCase::QUICK);
+  AddTestCase (new RtspTickDriverDelayTestCase, TestCase::QUICK);
+}
+
+static RtspTickDriverTestSuite g_rtspTickDriverTestSuite;